@@ -0,0 +1,206 @@
+#include "hip/hip_runtime.h"
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "../include/structs.h"
+#include "../cpp/include/files.h"
+#include "../cu/include/setup.cuh"
+#include "../cu/include/LBM.cuh"
+#include "../cu/include/LBMpull.cuh"
+#include "../cu/include/ordering.cuh"
+
+// Times the solver's IN=4 pull step, LBMpull with the BN it is built with,
+// on the input of a solver configuration file: first the dense row-major
+// LBMpullBin, then LBMpullOrdered with the fields stored in each node
+// ordering of ordering.h (the solver's ORDER build). Only the storage index
+// of a node changes, so every ordering must end with the same h and
+// populations as the dense run, bit for bit; the one to build with is the
+// fastest.
+//
+// usage: bin/bench-ordering config_file [steps] [reps]
+
+#if ORDER || LAZY || SPARSE || SLOPE || IN != 4
+	#error "bench-ordering sets the ordering at run time; build it with IN=4, ORDER=0, LAZY=0, SPARSE=0 and SLOPE=0"
+#endif
+
+// Median of the per-step times of reps repetitions of steps steps, each
+// continuing from the last; h and the populations after the first are
+// copied to hv and fv.
+template <class Step>
+static double timeRun(Step step, int steps, int reps, const prec* h, const prec* f1, const prec* f2,
+	size_t n, std::vector<prec>& hv, std::vector<prec>& fv) {
+	std::vector<double> samples(reps);
+	hipEvent_t ct1, ct2;
+	hipEventCreate(&ct1);
+	hipEventCreate(&ct2);
+	float dt;
+	for (int r = 0; r < reps; r++) {
+		hipEventRecord(ct1);
+		for (int t = 0; t < steps; t++)
+			step(r * steps + t);
+		hipEventRecord(ct2);
+		hipEventSynchronize(ct2);
+		hipEventElapsedTime(&dt, ct1, ct2);
+		samples[r] = dt / steps;
+		if (r == 0) {
+			hv.resize(n);
+			fv.resize(9 * n);
+			hipMemcpy(&hv[0], h, n * sizeof(prec), hipMemcpyDeviceToHost);
+			hipMemcpy(&fv[0], (steps % 2 == 0) ? f1 : f2, 9 * n * sizeof(prec), hipMemcpyDeviceToHost);
+		}
+	}
+	hipEventDestroy(ct1);
+	hipEventDestroy(ct2);
+	std::sort(samples.begin(), samples.end());
+	return (reps % 2 == 1) ? samples[reps / 2] : 0.5 * (samples[reps / 2 - 1] + samples[reps / 2]);
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cout << "usage: " << argv[0] << " config_file [steps] [reps]" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	int steps = (argc > 2) ? atoi(argv[2]) : 100;
+	int reps = (argc > 3) ? atoi(argv[3]) : 5;
+	if (steps < 1 || reps < 1) {
+		std::cout << "usage: " << argv[0] << " config_file [steps] [reps]" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	int time_array[3], Lx, Ly, Nblocks, autotune;
+	prec Dx, x0, y0, tau, g, Dt, activeTol = 1E-10;
+	collStruct coll;
+	coll.model = COLL_BGK;
+	coll.magic = 0.25;
+	coll.sE = 1.64;
+	coll.sEps = 1.54;
+	coll.sQ = 1.9;
+	std::string scenario, test, dir;
+	std::vector<std::string> patchNames;
+	prec *b, *w;
+	unsigned char* node_types;
+	readConf(dir, scenario, test, time_array, &tau, &g, &Dt, &Nblocks, &autotune, patchNames, &activeTol, &coll, argv[1]);
+	readInput(&b, &w, &node_types, scenario + "_" + test, dir + "../Inputs/", &Lx, &Ly, &Dx, &x0, &y0);
+	prec e = Dx / Dt;
+	collSetTau(&coll, tau);
+
+	size_t size = (size_t)Lx * Ly;
+	int Ngrid = int((size + Nblocks - 1) / Nblocks);
+	prec *bd, *wd, *h0, *h, *f1, *f2;
+	int* typesd;
+	unsigned char *SC_bin, *BB_bin;
+	hipMalloc((void**)&bd, size * sizeof(prec));
+	hipMalloc((void**)&wd, size * sizeof(prec));
+	hipMalloc((void**)&h0, size * sizeof(prec));
+	hipMalloc((void**)&h, size * sizeof(prec));
+	hipMalloc((void**)&f1, 9 * size * sizeof(prec));
+	hipMalloc((void**)&f2, 9 * size * sizeof(prec));
+	hipMalloc((void**)&typesd, size * sizeof(int));
+	hipMalloc((void**)&SC_bin, size * sizeof(unsigned char));
+	hipMalloc((void**)&BB_bin, size * sizeof(unsigned char));
+	hipMemcpy(bd, b, size * sizeof(prec), hipMemcpyHostToDevice);
+	hipMemcpy(wd, w, size * sizeof(prec), hipMemcpyHostToDevice);
+	uploadTypes(typesd, node_types, Lx, Ly, Nblocks);
+	hipLaunchKernelGGL(auxArraysKernel, dim3(Ngrid), dim3(Nblocks), 0, 0, Lx, Ly, typesd, SC_bin, BB_bin);
+	// Initial state of setupLevel: h from the free surface and bed, f at rest
+	hipLaunchKernelGGL(hKernel, dim3(Ngrid), dim3(Nblocks), 0, 0, Lx, Ly, wd, bd, h0);
+
+	std::cout << Lx << "x" << Ly << " nodes, " << steps << " steps x " << reps << " reps, " << PREC << "-bit, IN=4, BN="
+		<< BN << ", " << TILE << "x" << TILE << " tiles" << std::endl;
+	std::cout << std::setw(12) << "storage" << std::setw(11) << "nodes" << std::setw(12) << "median[ms]" << std::setw(9)
+		<< "MLUPS" << std::setw(9) << "speedup" << std::setw(12) << "max|dh|" << std::setw(12) << "max|df|" << std::endl;
+
+	// Dense row-major storage, as the ORDER=0 solver runs it
+	std::vector<prec> href, fref;
+	hipMemcpy(h, h0, size * sizeof(prec), hipMemcpyDeviceToDevice);
+	hipLaunchKernelGGL(feqKernel, dim3(Ngrid), dim3(Nblocks), 0, 0, Lx, Ly, g, e, h, f1);
+	hipMemset(f2, 0, 9 * size * sizeof(prec));
+	double dense = timeRun([&](int t) {
+		hipLaunchKernelGGL(LBMpullBin<BN>, dim3(Ngrid), dim3(Nblocks), 0, 0, Lx, Ly, g, e, coll, bd, (const sprec*)NULL,
+		SC_bin, BB_bin, (t % 2 == 0) ? f1 : f2, (t % 2 == 0) ? f2 : f1, h);
+	}, steps, reps, h, f1, f2, size, href, fref);
+	std::cout << std::setw(12) << "dense" << std::setw(11) << size << std::fixed << std::setprecision(4) << std::setw(12)
+		<< dense << std::setprecision(1) << std::setw(9) << size / (dense * 1e3) << std::setprecision(2) << std::setw(9) << 1.0 << std::endl;
+	hipFree(h);
+	hipFree(f1);
+	hipFree(f2);
+
+	bool match = true;
+	int best_type = -1;
+	double best = dense;
+	for (int type = ORDER_ROW; type <= ORDER_HILBERT; type++) {
+		orderStruct o;
+		orderInit(&o, type, Lx, Ly);
+		orderStruct od = orderUpload(o);
+		size_t n = o.size;
+		int Ogrid = int((n + Nblocks - 1) / Nblocks);
+		prec *bo, *ho, *f1o, *f2o;
+		unsigned char *SCo, *BBo;
+		hipMalloc((void**)&bo, n * sizeof(prec));
+		hipMalloc((void**)&ho, n * sizeof(prec));
+		hipMalloc((void**)&f1o, 9 * n * sizeof(prec));
+		hipMalloc((void**)&f2o, 9 * n * sizeof(prec));
+		hipMalloc((void**)&SCo, n * sizeof(unsigned char));
+		hipMalloc((void**)&BBo, n * sizeof(unsigned char));
+		hipLaunchKernelGGL(orderGatherKernel<prec>, dim3(Ogrid), dim3(Nblocks), 0, 0, od, bd, bo);
+		hipLaunchKernelGGL(orderGatherKernel<prec>, dim3(Ogrid), dim3(Nblocks), 0, 0, od, h0, ho);
+		hipLaunchKernelGGL(orderGatherKernel<unsigned char>, dim3(Ogrid), dim3(Nblocks), 0, 0, od, SC_bin, SCo);
+		hipLaunchKernelGGL(orderGatherKernel<unsigned char>, dim3(Ogrid), dim3(Nblocks), 0, 0, od, BB_bin, BBo);
+		hipLaunchKernelGGL(feqKernel, dim3(Ogrid), dim3(Nblocks), 0, 0, (int)n, 1, g, e, ho, f1o);
+		hipMemset(f2o, 0, 9 * n * sizeof(prec));
+
+		std::vector<prec> hv, fv;
+		double median = timeRun([&](int t) {
+			hipLaunchKernelGGL(LBMpullOrdered<BN>, dim3(Ogrid), dim3(Nblocks), 0, 0, od, g, e, coll, bo, SCo, BBo,
+			(t % 2 == 0) ? f1o : f2o, (t % 2 == 0) ? f2o : f1o, ho);
+		}, steps, reps, ho, f1o, f2o, n, hv, fv);
+
+		double dh = 0, df = 0;
+		for (int y = 0; y < Ly; y++)
+			for (int x = 0; x < Lx; x++) {
+				size_t i = x + (size_t)y * Lx, io = orderIndex(o, x, y);
+				dh = std::max(dh, (double)fabs(hv[io] - href[i]));
+				for (int k = 0; k < 9; k++)
+					df = std::max(df, (double)fabs(fv[io + k * n] - fref[i + k * size]));
+			}
+		bool same = (dh == 0 && df == 0);
+		match = match && same;
+		if (same && median < best) {
+			best = median;
+			best_type = type;
+		}
+		std::cout << std::setw(12) << orderName(type) << std::setw(11) << n << std::setprecision(4) << std::setw(12) << median
+			<< std::setprecision(1) << std::setw(9) << size / (median * 1e3) << std::setprecision(2) << std::setw(9)
+			<< dense / median << std::scientific << std::setw(12) << dh << std::setw(12) << df << std::fixed
+			<< (same ? "" : "  MISMATCH") << std::endl;
+
+		hipFree(bo);
+		hipFree(ho);
+		hipFree(f1o);
+		hipFree(f2o);
+		hipFree(SCo);
+		hipFree(BBo);
+		orderRelease(od);
+		orderFree(&o);
+	}
+	if (best_type < 0)
+		std::cout << "Fastest: dense storage, -D ORDER=0" << std::endl;
+	else
+		std::cout << "Fastest: " << orderName(best_type) << ", -D ORDER=" << best_type << std::endl;
+
+	hipFree(bd);
+	hipFree(wd);
+	hipFree(h0);
+	hipFree(typesd);
+	hipFree(SC_bin);
+	hipFree(BB_bin);
+	if (!match) {
+		std::cout << "Orderings disagree with the dense run." << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	return 0;
+}
@@ -0,0 +1,329 @@
+#include "hip/hip_runtime.h"
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "../include/structs.h"
+#include "../cpp/include/files.h"
+#include "../cu/include/setup.cuh"
+#include "../cu/include/LBM.cuh"
+#include "../cu/include/LBMpull.cuh"
+
+// Times the fifteen LBMpull variants, node classification IN 1-5 times
+// branch style BN 1-3, on the input of a solver configuration file, first with the
+// bed slopes recomputed from b (SL=0) and then read from the slopeKernel
+// array (SL=1, the solver's SLOPE build). Every variant starts from the same
+// state and must end with the same h and populations as IN=1, BN=1 with the
+// same SL; the one to keep on a machine is the fastest that matches. The
+// rounding of the stored slopes is reported as the difference of the two
+// IN=1, BN=1 runs.
+// Each is placed on the roofline of a STREAM triad measured at start-up and,
+// if given, the peak arithmetic rate of the device.
+//
+// usage: bin/bench-variants config_file [steps] [reps] [peak_gflops]
+
+#if LAZY || SPARSE || IN != 4
+	#error "bench-variants times the dense kernels; build it with IN=4, LAZY=0 and SPARSE=0"
+#endif
+
+typedef struct benchArrays {
+	int Lx;
+	int Ly;
+	int Nblocks;
+	int Ngrid;
+	prec g;
+	prec e;
+	collStruct coll;
+	prec* b;
+	prec* w;
+	sprec* slope;
+	int* node_types;
+	unsigned char* Arr_tri;
+	unsigned char* SC_bin;
+	unsigned char* BB_bin;
+	unsigned short* SCBB_bin;
+	prec* h;
+	prec* f1;
+	prec* f2;
+} benchArrays;
+
+// Memory traffic per node of LBMpull, each array counted once: b (or the 8
+// stored slopes) and h read for the stencil, f1 read, f2 and h written, plus
+// the classification data (none, node_types, 8 Arr_tri entries, SC_bin and
+// BB_bin, SCBB_bin).
+static double pullBytes(int in, int sl) {
+	double classification[5] = { 0, sizeof(int), 8 * sizeof(unsigned char), 2 * sizeof(unsigned char),
+		sizeof(unsigned short) };
+	return (2 - sl + 9 + 9 + 1) * sizeof(prec) + sl * 8 * sizeof(sprec) + classification[in - 1];
+}
+
+// Useful floating point operations per node, the same for every IN and BN:
+// bed slope forcing (6 per axis and 7 per diagonal direction, one less with
+// stored slopes, 5 for the factors), 22 for the moments, 90 for the
+// equilibrium and 27 for BGK. The blending of BN=3 executes more, which
+// shows up as a lower rate.
+static double pullFlops(int sl) {
+	return (4 * (6 - sl) + 4 * (7 - sl) + 5) + 22 + 90 + 27;
+}
+
+__global__ void triadKernel(int n, prec* a, const prec* __restrict__ b, const prec* __restrict__ c, prec s) {
+	int i = threadIdx.x + blockIdx.x*blockDim.x;
+	if (i < n)
+		a[i] = b[i] + s * c[i];
+}
+
+// Arr_tri from the bitmasks, as auxArraysKernel writes it with IN=3
+__global__ void triKernel(int Lx, int Ly, const unsigned char* __restrict__ SC_bin,
+	const unsigned char* __restrict__ BB_bin, unsigned char* Arr_tri) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	idx size = (idx)Lx * Ly;
+	if (i < size) {
+		Arr_tri[i] = 0;
+		for (int a = 1; a < 9; a++)
+			Arr_tri[i + a * size] = ((SC_bin[i] >> (a - 1)) & 1) + 2 * ((BB_bin[i] >> (a - 1)) & 1);
+	}
+}
+
+// SCBB_bin from the bitmasks, as auxArraysKernel writes it with IN=5
+__global__ void wordKernel(int Lx, int Ly, const unsigned char* __restrict__ SC_bin,
+	const unsigned char* __restrict__ BB_bin, unsigned short* SCBB_bin) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)Lx * Ly)
+		SCBB_bin[i] = (unsigned short)(SC_bin[i] | (BB_bin[i] << 8));
+}
+
+// Sustained bandwidth in GB/s: best of 10 STREAM triads a = b + s*c over
+// arrays far larger than the caches, counting 3 arrays per pass.
+static double streamTriad(int blockSize) {
+	const int n = 1 << 25;
+	const int reps = 10;
+	prec *a, *b, *c;
+	hipMalloc((void**)&a, n * sizeof(prec));
+	hipMalloc((void**)&b, n * sizeof(prec));
+	hipMalloc((void**)&c, n * sizeof(prec));
+	hipMemset(b, 0, n * sizeof(prec));
+	hipMemset(c, 0, n * sizeof(prec));
+	hipEvent_t ct1, ct2;
+	hipEventCreate(&ct1);
+	hipEventCreate(&ct2);
+	float dt, best = 0;
+	int grid = (n + blockSize - 1) / blockSize;
+	for (int r = 0; r <= reps; r++) {
+		hipEventRecord(ct1);
+		hipLaunchKernelGGL(triadKernel, dim3(grid), dim3(blockSize), 0, 0, n, a, b, c, (prec)3.0);
+		hipEventRecord(ct2);
+		hipEventSynchronize(ct2);
+		hipEventElapsedTime(&dt, ct1, ct2);
+		// the first pass only warms up
+		if (r == 1 || (r > 1 && dt < best))
+			best = dt;
+	}
+	hipEventDestroy(ct1);
+	hipEventDestroy(ct2);
+	hipFree(a);
+	hipFree(b);
+	hipFree(c);
+	return 3.0 * n * sizeof(prec) / (best * 1e6);
+}
+
+template <int bn>
+static void pullLaunch(int in, const benchArrays& a, const sprec* slope, const prec* fsrc, prec* fdst) {
+	if (in == 1)
+		hipLaunchKernelGGL(LBMpullDepth<bn>, dim3(a.Ngrid), dim3(a.Nblocks), 0, 0, a.Lx, a.Ly, a.g, a.e, a.coll,
+		a.b, slope, fsrc, fdst, a.h);
+	else if (in == 2)
+		hipLaunchKernelGGL(LBMpullTypes<bn>, dim3(a.Ngrid), dim3(a.Nblocks), 0, 0, a.Lx, a.Ly, a.g, a.e, a.coll,
+		a.b, slope, a.node_types, fsrc, fdst, a.h);
+	else if (in == 3)
+		hipLaunchKernelGGL(LBMpullTri<bn>, dim3(a.Ngrid), dim3(a.Nblocks), 0, 0, a.Lx, a.Ly, a.g, a.e, a.coll,
+		a.b, slope, a.Arr_tri, fsrc, fdst, a.h);
+	else if (in == 4)
+		hipLaunchKernelGGL(LBMpullBin<bn>, dim3(a.Ngrid), dim3(a.Nblocks), 0, 0, a.Lx, a.Ly, a.g, a.e, a.coll,
+		a.b, slope, a.SC_bin, a.BB_bin, fsrc, fdst, a.h);
+	else
+		hipLaunchKernelGGL(LBMpullWord<bn>, dim3(a.Ngrid), dim3(a.Nblocks), 0, 0, a.Lx, a.Ly, a.g, a.e, a.coll,
+		a.b, slope, a.SCBB_bin, fsrc, fdst, a.h);
+}
+
+static void pullStep(int in, int bn, int sl, const benchArrays& a, int t) {
+	const sprec* slope = sl ? a.slope : NULL;
+	const prec* fsrc = (t % 2 == 0) ? a.f1 : a.f2;
+	prec* fdst = (t % 2 == 0) ? a.f2 : a.f1;
+	if (bn == 1)
+		pullLaunch<1>(in, a, slope, fsrc, fdst);
+	else if (bn == 2)
+		pullLaunch<2>(in, a, slope, fsrc, fdst);
+	else
+		pullLaunch<3>(in, a, slope, fsrc, fdst);
+}
+
+// Initial state of setupLevel: h from the free surface and bed, f at rest
+static void reset(const benchArrays& a) {
+	hipLaunchKernelGGL(hKernel, dim3(a.Ngrid), dim3(a.Nblocks), 0, 0, a.Lx, a.Ly, a.w, a.b, a.h);
+	hipLaunchKernelGGL(feqKernel, dim3(a.Ngrid), dim3(a.Nblocks), 0, 0, a.Lx, a.Ly, a.g, a.e, a.h, a.f1);
+	hipMemset(a.f2, 0, 9 * (size_t)a.Lx * a.Ly * sizeof(prec));
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cout << "usage: " << argv[0] << " config_file [steps] [reps] [peak_gflops]" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	int steps = (argc > 2) ? atoi(argv[2]) : 100;
+	int reps = (argc > 3) ? atoi(argv[3]) : 5;
+	double peak = (argc > 4) ? atof(argv[4]) : 0;
+	if (steps < 1 || reps < 1) {
+		std::cout << "usage: " << argv[0] << " config_file [steps] [reps] [peak_gflops]" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	int time_array[3], Lx, Ly, Nblocks, autotune;
+	prec Dx, x0, y0, tau, g, Dt, activeTol = 1E-10;
+	collStruct coll;
+	coll.model = COLL_BGK;
+	coll.magic = 0.25;
+	coll.sE = 1.64;
+	coll.sEps = 1.54;
+	coll.sQ = 1.9;
+	std::string scenario, test, dir;
+	std::vector<std::string> patchNames;
+	prec *b, *w;
+	unsigned char* node_types;
+	readConf(dir, scenario, test, time_array, &tau, &g, &Dt, &Nblocks, &autotune, patchNames, &activeTol, &coll, argv[1]);
+	readInput(&b, &w, &node_types, scenario + "_" + test, dir + "../Inputs/", &Lx, &Ly, &Dx, &x0, &y0);
+
+	benchArrays a;
+	size_t size = (size_t)Lx * Ly;
+	a.Lx = Lx;
+	a.Ly = Ly;
+	a.Nblocks = Nblocks;
+	a.Ngrid = int((size + Nblocks - 1) / Nblocks);
+	a.g = g;
+	a.e = Dx / Dt;
+	collSetTau(&coll, tau);
+	a.coll = coll;
+	hipMalloc((void**)&a.b, size * sizeof(prec));
+	hipMalloc((void**)&a.w, size * sizeof(prec));
+	hipMalloc((void**)&a.slope, 8 * size * sizeof(sprec));
+	hipMalloc((void**)&a.node_types, size * sizeof(int));
+	hipMalloc((void**)&a.Arr_tri, 9 * size * sizeof(unsigned char));
+	hipMalloc((void**)&a.SC_bin, size * sizeof(unsigned char));
+	hipMalloc((void**)&a.BB_bin, size * sizeof(unsigned char));
+	hipMalloc((void**)&a.SCBB_bin, size * sizeof(unsigned short));
+	hipMalloc((void**)&a.h, size * sizeof(prec));
+	hipMalloc((void**)&a.f1, 9 * size * sizeof(prec));
+	hipMalloc((void**)&a.f2, 9 * size * sizeof(prec));
+	hipMemcpy(a.b, b, size * sizeof(prec), hipMemcpyHostToDevice);
+	hipMemcpy(a.w, w, size * sizeof(prec), hipMemcpyHostToDevice);
+	uploadTypes(a.node_types, node_types, Lx, Ly, Nblocks);
+	hipLaunchKernelGGL(auxArraysKernel, dim3(a.Ngrid), dim3(a.Nblocks), 0, 0, Lx, Ly, a.node_types,
+	a.SC_bin, a.BB_bin);
+	hipLaunchKernelGGL(triKernel, dim3(a.Ngrid), dim3(a.Nblocks), 0, 0, Lx, Ly, a.SC_bin, a.BB_bin, a.Arr_tri);
+	hipLaunchKernelGGL(wordKernel, dim3(a.Ngrid), dim3(a.Nblocks), 0, 0, Lx, Ly, a.SC_bin, a.BB_bin, a.SCBB_bin);
+	hipLaunchKernelGGL(slopeKernel, dim3(a.Ngrid), dim3(a.Nblocks), 0, 0, Lx, Ly, a.b, a.slope);
+
+	double triad = streamTriad(Nblocks);
+	std::cout << Lx << "x" << Ly << " nodes, " << steps << " steps x " << reps << " reps, " << PREC << "-bit, "
+		<< pullBytes(4, 0) << " bytes and " << pullFlops(0) << " flops per node (IN=4), "
+		<< 8 * sizeof(sprec) << "-bit stored slopes" << std::endl;
+	std::cout << std::fixed << std::setprecision(1) << "Roofline: triad " << triad << " GB/s";
+	if (peak > 0)
+		std::cout << ", peak " << peak << " GFLOP/s";
+	std::cout << std::endl;
+	std::cout << std::setw(4) << "SL" << std::setw(4) << "IN" << std::setw(4) << "BN" << std::setw(12) << "median[ms]" << std::setw(10)
+		<< "min[ms]" << std::setw(9) << "MLUPS" << std::setw(8) << "GB/s" << std::setw(7) << "%BW"
+		<< std::setw(9) << "GFLOP/s" << std::setw(7) << "%peak" << std::setw(12) << "max|dh|"
+		<< std::setw(12) << "max|df|" << std::endl;
+
+	std::vector<prec> href[2], fref[2], hv(size), fv(9 * size);
+	std::vector<double> samples(reps);
+	hipEvent_t ct1, ct2;
+	hipEventCreate(&ct1);
+	hipEventCreate(&ct2);
+	float dt;
+	bool match = true;
+	int best_in = 0, best_bn = 0, best_sl = 0;
+	double best = 0;
+	for (int sl = 0; sl <= 1; sl++)
+	for (int in = 1; in <= 5; in++)
+		for (int bn = 1; bn <= 3; bn++) {
+			// the first repetition runs from the initial state and is the one compared
+			reset(a);
+			for (int r = 0; r < reps; r++) {
+				hipEventRecord(ct1);
+				for (int t = 0; t < steps; t++)
+					pullStep(in, bn, sl, a, r * steps + t);
+				hipEventRecord(ct2);
+				hipEventSynchronize(ct2);
+				hipEventElapsedTime(&dt, ct1, ct2);
+				samples[r] = dt / steps;
+				if (r == 0) {
+					hipMemcpy(&hv[0], a.h, size * sizeof(prec), hipMemcpyDeviceToHost);
+					hipMemcpy(&fv[0], (steps % 2 == 0) ? a.f1 : a.f2, 9 * size * sizeof(prec), hipMemcpyDeviceToHost);
+				}
+			}
+			if (in == 1 && bn == 1) {
+				href[sl] = hv;
+				fref[sl] = fv;
+			}
+			double dh = 0, df = 0;
+			for (size_t i = 0; i < size; i++)
+				dh = std::max(dh, (double)fabs(hv[i] - href[sl][i]));
+			for (size_t i = 0; i < 9 * size; i++)
+				df = std::max(df, (double)fabs(fv[i] - fref[sl][i]));
+			bool same = (dh <= 1E-10 && df <= 1E-10);
+			match = match && same;
+
+			std::sort(samples.begin(), samples.end());
+			double median = (reps % 2 == 1) ? samples[reps / 2] : 0.5 * (samples[reps / 2 - 1] + samples[reps / 2]);
+			double mlups = (double)size / (median * 1e3);
+			double gbs = mlups * pullBytes(in, sl) * 1e-3;
+			double gflops = mlups * pullFlops(sl) * 1e-3;
+			if (same && mlups > best) {
+				best = mlups;
+				best_in = in;
+				best_bn = bn;
+				best_sl = sl;
+			}
+			std::cout << std::setw(4) << sl << std::setw(4) << in << std::setw(4) << bn << std::setprecision(4) << std::setw(12) << median
+				<< std::setw(10) << samples[0] << std::setprecision(1) << std::setw(9) << mlups << std::setw(8) << gbs
+				<< std::setw(7) << 100 * gbs / triad << std::setw(9) << gflops;
+			if (peak > 0)
+				std::cout << std::setw(7) << 100 * gflops / peak;
+			else
+				std::cout << std::setw(7) << "-";
+			std::cout << std::scientific << std::setprecision(2) << std::setw(12) << dh << std::setw(12) << df
+				<< std::fixed << (same ? "" : "  MISMATCH") << std::endl;
+		}
+	hipEventDestroy(ct1);
+	hipEventDestroy(ct2);
+	double dh = 0, df = 0;
+	for (size_t i = 0; i < size; i++)
+		dh = std::max(dh, (double)fabs(href[1][i] - href[0][i]));
+	for (size_t i = 0; i < 9 * size; i++)
+		df = std::max(df, (double)fabs(fref[1][i] - fref[0][i]));
+	std::cout << "Stored slopes against recomputed (IN=1, BN=1): max|dh| " << std::scientific << std::setprecision(2)
+		<< dh << ", max|df| " << df << std::fixed << std::endl;
+	std::cout << "Fastest matching variant: -D IN=" << best_in << " -D BN=" << best_bn << " -D SLOPE="
+		<< best_sl * 8 * sizeof(sprec) << " (" << std::setprecision(1) << best << " MLUPS)" << std::endl;
+
+	hipFree(a.b);
+	hipFree(a.w);
+	hipFree(a.slope);
+	hipFree(a.node_types);
+	hipFree(a.Arr_tri);
+	hipFree(a.SC_bin);
+	hipFree(a.BB_bin);
+	hipFree(a.SCBB_bin);
+	hipFree(a.h);
+	hipFree(a.f1);
+	hipFree(a.f2);
+	if (!match) {
+		std::cout << "Variants disagree with IN=1, BN=1." << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	return 0;
+}
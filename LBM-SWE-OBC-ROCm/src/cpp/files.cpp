@@ -3,15 +3,18 @@
 #include <string>
 #include <stdlib.h>
 #include <stdio.h>
+#include <climits>
 #include <iomanip>
 #include <iostream>
 #include <vector>
 #include "include/files.h"
 #include "../include/structs.h"
+#include "../cu/include/alloc.cuh"
 
 void readConf(std::string& dir, std::string& scenario,
 	std::string& test, int *timearray, prec *tau,
-	prec *g, prec *Dt, int *Nblocks, std::string file) {
+	prec *g, prec *Dt, int *Nblocks, int *autotune, std::vector<std::string>& patches,
+	prec *activeTol, collStruct *coll, std::string file) {
 	std::ifstream myfile;
 	myfile.open(file.c_str(), std::ios::in);
 	if (!myfile.is_open()) {
@@ -29,7 +32,41 @@ void readConf(std::string& dir, std::string& scenario,
 	myfile >> skip >> skip >> *tau;
 	myfile >> skip >> skip >> *g;
 	myfile >> skip >> skip >> *Dt;
-	myfile >> skip >> skip >> *Nblocks;
+	// Nblocks = auto takes the tuned value from the cache (tuning it if missing),
+	// Nblocks = tune searches again; both start from 256
+	std::string blocks;
+	myfile >> skip >> skip >> blocks;
+	*autotune = (blocks == "auto") ? 1 : (blocks == "tune") ? 2 : 0;
+	*Nblocks = (*autotune != 0) ? 256 : atoi(blocks.c_str());
+	std::string key, value;
+	while (myfile >> key >> skip >> value) {
+		if (key == "Patch")
+			patches.push_back(value);
+		else if (key == "ActiveTol")
+			*activeTol = atof(value.c_str());
+		else if (key == "Collision") {
+			if (value == "BGK")
+				coll->model = COLL_BGK;
+			else if (value == "TRT")
+				coll->model = COLL_TRT;
+			else if (value == "MRT")
+				coll->model = COLL_MRT;
+			else {
+				std::cout << "Unknown collision operator " << value << "." << std::endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+		else if (key == "Magic")
+			coll->magic = atof(value.c_str());
+		else if (key == "RateE")
+			coll->sE = atof(value.c_str());
+		else if (key == "RateEps")
+			coll->sEps = atof(value.c_str());
+		else if (key == "RateQ")
+			coll->sQ = atof(value.c_str());
+		else
+			std::cout << "Unknown configuration key " << key << " ignored." << std::endl;
+	}
 	myfile.close();
 }
 
@@ -47,7 +84,7 @@ prec stod(char* word, int len) {
 }
 
 void readInput(prec** b, prec** w,
-	int** node_types, std::string test, std::string inputdir,
+	unsigned char** node_types, std::string test, std::string inputdir,
 	int *Lx, int *Ly, prec *Dx, prec* x0, prec* y0) {
 	FILE *fp;
 	std::string fullfile = inputdir + test + ".txt";
@@ -62,21 +99,34 @@ void readInput(prec** b, prec** w,
 	#else
 		fscanf(fp, "%d %d %f %f %f\n", Lx, Ly, Dx, x0, y0);
 	#endif
+	#if INDEX == 32
+		// idx is an int, so every population index has to fit in one
+		if (9 * (size_t)(*Lx) * (*Ly) > INT_MAX) {
+			std::cout << "A " << *Lx << "x" << *Ly << " grid has too many populations for INDEX=32, rebuild with INDEX=64." << std::endl;
+			exit(EXIT_FAILURE);
+		}
+	#endif
 
-	prec* bl = new prec[(*Lx)*(*Ly)];
-	prec* wl = new prec[(*Lx)*(*Ly)];
-	int* node_typesl = new int[(*Lx)*(*Ly)];
-	int wc = 0, bc = 0, len = 0, buflen;
+	size_t size = (size_t)(*Lx) * (*Ly);
+	prec* bl = (prec*)hostFieldAlloc("b", size * sizeof(prec));
+	prec* wl = (prec*)hostFieldAlloc("w", size * sizeof(prec));
+	unsigned char* node_typesl = (unsigned char*)hostFieldAlloc("node_types", TYPES_BYTES(size));
+	size_t wc = 0, bc = 0;
+	int len = 0, buflen;
 	prec val;
 	char buffer[FILE_BATCH_SIZE], word[50];
 	buffer[FILE_BATCH_SIZE - 1] = '\0';
-	while (wc < (*Lx)*(*Ly) || wc < (*Lx)*(*Ly)) {
+	while (wc < size) {
 		buflen = fread(buffer, 1, FILE_BATCH_SIZE - 1, fp);
 		for (int i = 0; i <= buflen; i++) {
 			if (buffer[i] == ' ' || buffer[i] == '\n' || buffer[i] == '\r') {
 				word[len] = '\0';
 				if (len == 1)
-					node_typesl[wc - 1] = word[0] - '0';
+				{
+					size_t k = (wc - 1) / 4;
+					int shift = 2 * ((wc - 1) % 4);
+					node_typesl[k] = (node_typesl[k] & ~(3 << shift)) | (((word[0] - '0') & 3) << shift);
+				}
 				else if (len > 1) {
 					val = stod(word,len);
 					if (wc == bc) {
@@ -129,7 +179,7 @@ void readTSloc(prec** x, prec** y, int* NTS, std::string scenario, std::string i
 	*y = yl;
 }
 
-void writeOutput(int L, int t, prec* w, std::string outputdir) {
+void writeOutput(size_t L, int t, prec* w, std::string outputdir) {
 	FILE *fp;
 	std::ostringstream numero; 
 	numero << std::setw(5) << std::setfill('0') << std::right << (t);
@@ -165,9 +215,9 @@ void writeTS(int TTS, int NTS, int deltaTS, prec Dt, prec* TSdata, std::string o
 	}
 	myfile << std::endl;
 	for (i = 0; i < NTS; i++) {
-		myfile << TSdata[i*TTS];
+		myfile << TSdata[(size_t)i*TTS];
 		for (j = 1; j < TTS; j++) {
-			myfile << " " << TSdata[i*TTS + j];
+			myfile << " " << TSdata[(size_t)i*TTS + j];
 		}
 		myfile << std::endl;
 	}
@@ -3,16 +3,17 @@
 
 #include "../../include/structs.h"
 #include <string>
+#include <vector>
 
 void readConf(std::string&, std::string&, std::string&, int*,
-	prec*, prec*, prec*, int*, std::string);
+	prec*, prec*, prec*, int*, int*, std::vector<std::string>&, prec*, collStruct*, std::string);
 
-void readInput(prec**, prec**, int**, std::string, std::string, 
+void readInput(prec**, prec**, unsigned char**, std::string, std::string, 
 	int*, int*, prec*, prec*, prec*);
 
 void readTSloc(prec**, prec**, int*, std::string, std::string);
 
-void writeOutput(int, int, prec*, std::string);
+void writeOutput(size_t, int, prec*, std::string);
 
 void writeConf(int, int, prec, prec, prec, std::string);
 
@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include "../include/structs.h"
+
+static unsigned long long mortonKey(int x, int y) {
+	unsigned long long key = 0;
+	for (int b = 0; b < 32; b++) {
+		key |= (unsigned long long)((x >> b) & 1) << (2 * b);
+		key |= (unsigned long long)((y >> b) & 1) << (2 * b + 1);
+	}
+	return key;
+}
+
+// Distance along the Hilbert curve filling an n x n square (n a power of two).
+static unsigned long long hilbertKey(int n, int x, int y) {
+	unsigned long long key = 0;
+	for (int s = n / 2; s > 0; s /= 2) {
+		int rx = (x & s) > 0;
+		int ry = (y & s) > 0;
+		key += (unsigned long long)s * s * ((3 * rx) ^ ry);
+		if (ry == 0) {
+			if (rx == 1) {
+				x = s - 1 - x;
+				y = s - 1 - y;
+			}
+			int t = x;
+			x = y;
+			y = t;
+		}
+	}
+	return key;
+}
+
+const char* orderName(int type) {
+	switch (type) {
+		case ORDER_ROW: return "row-major";
+		case ORDER_MORTON: return "Morton";
+		case ORDER_HILBERT: return "Hilbert";
+	}
+	return "unknown";
+}
+
+void orderInit(orderStruct* o, int type, int Lx, int Ly) {
+	if (type < ORDER_ROW || type > ORDER_HILBERT) {
+		std::cout << "Unknown node ordering " << type << "." << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	o->type = type;
+	o->Lx = Lx;
+	o->Ly = Ly;
+	o->NTx = (Lx + TILE - 1) / TILE;
+	o->NTy = (Ly + TILE - 1) / TILE;
+	o->tileSlot = NULL;
+	o->tileXY = NULL;
+	if (type == ORDER_ROW) {
+		o->size = (idx)Lx * Ly;
+		return;
+	}
+
+	// Tiles are ranked by their curve key, so a rectangular grid is packed
+	// without the holes a padded power-of-two square would leave.
+	int NT = o->NTx * o->NTy;
+	int n = 1;
+	while (n < o->NTx || n < o->NTy)
+		n *= 2;
+	std::vector<std::pair<unsigned long long, int> > keys(NT);
+	for (int t = 0; t < NT; t++) {
+		int tx = t % o->NTx, ty = t / o->NTx;
+		keys[t].first = (type == ORDER_MORTON) ? mortonKey(tx, ty) : hilbertKey(n, tx, ty);
+		keys[t].second = t;
+	}
+	std::sort(keys.begin(), keys.end());
+	o->tileSlot = (int*)malloc(NT * sizeof(int));
+	o->tileXY = (int*)malloc(2 * NT * sizeof(int));
+	for (int s = 0; s < NT; s++) {
+		int t = keys[s].second;
+		o->tileSlot[t] = s;
+		o->tileXY[2 * s] = t % o->NTx;
+		o->tileXY[2 * s + 1] = t / o->NTx;
+	}
+	o->size = (idx)NT * TILE * TILE;
+}
+
+void orderFree(orderStruct* o) {
+	free(o->tileSlot);
+	free(o->tileXY);
+	o->tileSlot = NULL;
+	o->tileXY = NULL;
+}
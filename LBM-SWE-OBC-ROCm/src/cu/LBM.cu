@@ -1,8 +1,17 @@
 #include "hip/hip_runtime.h"
 #include "hip/hip_runtime.h"
 #include "include/setup.cuh"
+#include "include/LBMpull.cuh"
+#include "include/refine.cuh"
+#include "include/sparse.cuh"
+#include "include/ordering.cuh"
+#include "include/pop16.cuh"
+#include "include/alloc.cuh"
 #include "../cpp/include/files.h"
 #include "../include/structs.h"
+#include "../include/perf.h"
+#include <stdlib.h>
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <math.h>
@@ -15,868 +24,514 @@
 __global__ void wKernel(int Lx, int Ly, const prec* __restrict__ h,
 	const prec* __restrict__ b, prec* w) {
 
-	int i = threadIdx.x + blockIdx.x*blockDim.x;
-	if (i < Lx*Ly) {
-		w[i] = h[i] + b[i];
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)Lx*Ly) {
+		w[i] = h[ghostIndex(i, Lx)] + b[i];
 	}
 }
 
-#if IN == 1
-__global__ void LBMpull(int Lx, int Ly, prec g, prec e, prec tau,
-	const prec* __restrict__ b, const prec* __restrict__ f1, 
-	prec* f2, prec* h) {
-	int i = threadIdx.x + blockIdx.x*blockDim.x;
-	int size = Lx * Ly, j;
-	prec ftemp[9], feq[9];
-	prec uxlocal, uylocal;
-	prec hlocal[9], blocal[9];
-	prec gh, usq, ux3, uy3, uxuy5, uxuy6;
-	prec fact1 = 1 / (9 * e*e);
-	prec fact2 = fact1 * 0.25;
-	prec factS = fact1 * 1.5;
-	unsigned char trilocal[8]; 
-	int nt[9]; 
-	if (i < size) {
-		hlocal[0] = h[i];
-		if (hlocal[0] > 0){
-			int y = (int)i / Lx;
-			int x = i - y * Lx;
-
-			blocal[0] = b[i];
-			blocal[1] = (             x != 0   ) ? b[i      - 1] : 0;
-			blocal[2] = (y != 0                ) ? b[i - Lx    ] : 0;
-			blocal[3] = (             x != Lx-1) ? b[i      + 1] : 0;
-			blocal[4] = (y != Ly-1             ) ? b[i + Lx    ] : 0;
-			blocal[5] = (y != 0    && x != 0   ) ? b[i - Lx - 1] : 0;
-			blocal[6] = (y != 0    && x != Lx-1) ? b[i - Lx + 1] : 0;
-			blocal[7] = (y != Ly-1 && x != Lx-1) ? b[i + Lx + 1] : 0; 
-			blocal[8] = (y != Ly-1 && x != 0   ) ? b[i + Lx - 1] : 0;
-
-			hlocal[1] = (             x != 0   ) ? h[i      - 1] : 0;
-			hlocal[2] = (y != 0                ) ? h[i - Lx    ] : 0;
-			hlocal[3] = (             x != Lx-1) ? h[i      + 1] : 0;
-			hlocal[4] = (y != Ly-1             ) ? h[i + Lx    ] : 0;
-			hlocal[5] = (y != 0    && x != 0   ) ? h[i - Lx - 1] : 0;
-			hlocal[6] = (y != 0    && x != Lx-1) ? h[i - Lx + 1] : 0;
-			hlocal[7] = (y != Ly-1 && x != Lx-1) ? h[i + Lx + 1] : 0;
-			hlocal[8] = (y != Ly-1 && x != 0   ) ? h[i + Lx - 1] : 0;
-
-			ftemp[1] = (             x != 0   ) ? f1[i      - 1 +     size] : 0;
-			ftemp[2] = (y != 0                ) ? f1[i - Lx     + 2 * size] : 0;
-			ftemp[3] = (             x != Lx-1) ? f1[i      + 1 + 3 * size] : 0;
-			ftemp[4] = (y != Ly-1             ) ? f1[i + Lx     + 4 * size] : 0;
-			ftemp[5] = (y != 0    && x != 0   ) ? f1[i - Lx - 1 + 5 * size] : 0;
-			ftemp[6] = (y != 0    && x != Lx-1) ? f1[i - Lx + 1 + 6 * size] : 0;
-			ftemp[7] = (y != Ly-1 && x != Lx-1) ? f1[i + Lx + 1 + 7 * size] : 0;
-			ftemp[8] = (y != Ly-1 && x != 0   ) ? f1[i + Lx - 1 + 8 * size] : 0;
-
-			for (int a = 0; a < 9; a++){
-				nt[a] = 0;
-				if (hlocal[a] > 0) nt[a] = 2;
-			}
+__global__ void feqKernel(int Lx, int Ly, prec g, prec e,
+	const prec* __restrict__ h, pop* f
+	#if POP16
+	, const prec* __restrict__ b, const float* __restrict__ s, unsigned char* popFlags,
+	const prec* __restrict__ wt
+	#endif
+	) {
 
-			for (int a = 1; a < 9; a++){
-				if (!((y == 0 && (a == 2 || a == 5 || a == 6)) ||
-					  (y == Ly-1 && (a == 4 || a == 7 || a == 8)) ||
-					  (x == 0 && (a == 1 || a == 5 || a == 8)) ||
-					  (x == Lx-1 && (a == 3 || a == 6 || a == 7))))
-					if (nt[a] == 0) nt[0] = 1;
-			}
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	idx size = (idx)Lx * Ly;
+	if (i < size) {   // f0 f0 f0 f0 ... f1 f1 f1 f1 f1 .. f2 f2 f2 f2 f2 .... f3 f3 f3 f3 f3 .....
+		prec hi = h[ghostIndex(i, Lx)];
+		prec gh1 = g * hi * hi / (6.0 * e * e);
+		prec gh2 = gh1 / 4;
+		#if POP16
+			popNode pn = popNodeInit(i, Lx, b[i], wt, s, s, g, e);
+			storeNodePop(f, popFlags, pn, i, 0, size, hi - 5.0 * gh1);
+			for (int k = 1; k < 9; k++)
+				storeNodePop(f, popFlags, pn, i, k, size, (k < 5) ? gh1 : gh2);
+		#elif GHOST
+			idx n = ghostIndex(i, Lx);
+			idx fsize = ghostSize(Lx, Ly);
+			f[n] = hi - 5.0 * gh1;
+			for (int k = 1; k < 9; k++)
+				f[n + k * fsize] = (k < 5) ? gh1 : gh2;
+		#else
+		f[i] = hi - 5.0 * gh1;
+		f[i +     size] = gh1;
+		f[i + 2 * size] = gh1;
+		f[i + 3 * size] = gh1;
+		f[i + 4 * size] = gh1;
+		f[i + 5 * size] = gh2;
+		f[i + 6 * size] = gh2;
+		f[i + 7 * size] = gh2;
+		f[i + 8 * size] = gh2;
+		#endif
+	}
+}
 
-			for (int a = 0; a<8; a++) trilocal[a] = 0;
-			if (nt[0] == 2) {
-				if (y == 0) {
-					if (x == 0) {
-						trilocal[2] = 1;
-						trilocal[3] = 1;
-						trilocal[6] = 1; 
-					}
-					else if (x == Lx - 1) {
-						trilocal[0] = 1;
-						trilocal[3] = 1;
-						trilocal[7] = 1;
-					}
-					else {
-						trilocal[0] = 1;
-						trilocal[2] = 1;
-						trilocal[3] = 1;
-						trilocal[6] = 1;
-						trilocal[7] = 1;
-					}
-				}
-				else if (y == Ly - 1) {
-					if (x == 0) {
-						trilocal[1] = 1;
-						trilocal[2] = 1;
-						trilocal[5] = 1;
-					}
-					else if (x == Lx - 1) {
-						trilocal[0] = 1;
-						trilocal[1] = 1;
-						trilocal[4] = 1;
-					}
-					else {
-						trilocal[0] = 1;
-						trilocal[1] = 1;
-						trilocal[2] = 1;
-						trilocal[4] = 1;
-						trilocal[5] = 1;
-					}
-				}
-				else {
-					if (x == 0) {
-						trilocal[1] = 1;
-						trilocal[2] = 1;
-						trilocal[3] = 1;
-						trilocal[5] = 1;
-						trilocal[6] = 1;
-					}
-					else if (x == Lx - 1) {
-						trilocal[0] = 1;
-						trilocal[1] = 1;
-						trilocal[3] = 1;
-						trilocal[4] = 1;
-						trilocal[7] = 1;
-					}
-					else {
-						for (int a = 0; a<8; a++) {
-							trilocal[a] = 1;
-						}
-					}
+#if POP16
+// Still-water level of every tile and initial scale of each direction:
+// the largest deviation of the feqKernel state from the rest state lands
+// in [2^13, 2^14).
+__global__ void popScaleInitKernel(int Lx, int Ly, prec g, prec e,
+	const prec* __restrict__ h, const prec* __restrict__ b, float* s, prec* wt) {
+
+	int tk = threadIdx.x + blockIdx.x*blockDim.x;
+	int NTx = (Lx + TILE - 1) / TILE, NTy = (Ly + TILE - 1) / TILE;
+	if (tk < 9 * NTx * NTy) {
+		int k = tk % 9, t = tk / 9;
+		int x0 = (t % NTx) * TILE, y0 = (t / NTx) * TILE;
+		int x1 = (x0 + TILE < Lx) ? x0 + TILE : Lx, y1 = (y0 + TILE < Ly) ? y0 + TILE : Ly;
+		prec wsum = 0, dev = 0;
+		int wet = 0;
+		for (int y = y0; y < y1; y++)
+			for (int x = x0; x < x1; x++) {
+				idx i = x + (idx)y * Lx;
+				if (h[i] > 0) {
+					wsum += h[i] + b[i];
+					wet++;
 				}
 			}
-			else if (nt[0] == 1) {
-				if (y == 0) {
-					trilocal[0] = 1;
-					trilocal[3] = 1;
-					trilocal[7] = 1;
-					trilocal[2] = 2;
-					trilocal[5] = 2;
-					trilocal[6] = 2;
-				}
-				else if (y == Ly - 1) {
-					trilocal[0] = 1;
-					trilocal[1] = 1;
-					trilocal[4] = 1;
-					trilocal[2] = 2;
-					trilocal[5] = 2;
-					trilocal[6] = 2;
-				}
-				else {
-					for (int a = 1; a<9; a++){
-						if (nt[a] != 0)
-							trilocal[a-1] = 1;
-						else
-							trilocal[a-1] = 2;
-					}
-					if (nt[5] == 0 || (nt[5] != 0 && (nt[1] == 0 || nt[2] == 0))) trilocal[4] = 2;
-					if (nt[6] == 0 || (nt[6] != 0 && (nt[2] == 0 || nt[3] == 0))) trilocal[5] = 2;
-					if (nt[7] == 0 || (nt[7] != 0 && (nt[3] == 0 || nt[4] == 0))) trilocal[6] = 2;
-					if (nt[8] == 0 || (nt[8] != 0 && (nt[4] == 0 || nt[1] == 0))) trilocal[7] = 2;
-				} 
+		prec wl = (wet > 0) ? wsum / wet : 0;
+		for (int y = y0; y < y1; y++)
+			for (int x = x0; x < x1; x++) {
+				idx i = x + (idx)y * Lx;
+				prec hi = h[i];
+				prec gh1 = g * hi * hi / (6.0 * e * e);
+				prec feq = (k == 0) ? hi - 5.0 * gh1 : ((k < 5) ? gh1 : gh1 / 4);
+				dev = fmax(dev, fabs(feq - restPop(k, wl - b[i], g, e)));
 			}
-
-			ftemp[0] = f1[i]; 
-			#if BN == 1
-				if(trilocal[0] == 1) ftemp[1] = ftemp[1] - g * (hlocal[0] + hlocal[1]) * (blocal[0] - blocal[1]) * factS; else ftemp[1] = f1[i +     size];
-				if(trilocal[1] == 1) ftemp[2] = ftemp[2] - g * (hlocal[0] + hlocal[2]) * (blocal[0] - blocal[2]) * factS; else ftemp[2] = f1[i + 2 * size];
-				if(trilocal[2] == 1) ftemp[3] = ftemp[3] - g * (hlocal[0] + hlocal[3]) * (blocal[0] - blocal[3]) * factS; else ftemp[3] = f1[i + 3 * size];
-				if(trilocal[3] == 1) ftemp[4] = ftemp[4] - g * (hlocal[0] + hlocal[4]) * (blocal[0] - blocal[4]) * factS; else ftemp[4] = f1[i + 4 * size];
-				if(trilocal[4] == 1) ftemp[5] = ftemp[5] - g * (hlocal[0] + hlocal[5]) * (blocal[0] - blocal[5]) * factS * 0.25; else ftemp[5] = f1[i + 5 * size];
-				if(trilocal[5] == 1) ftemp[6] = ftemp[6] - g * (hlocal[0] + hlocal[6]) * (blocal[0] - blocal[6]) * factS * 0.25; else ftemp[6] = f1[i + 6 * size];
-				if(trilocal[6] == 1) ftemp[7] = ftemp[7] - g * (hlocal[0] + hlocal[7]) * (blocal[0] - blocal[7]) * factS * 0.25; else ftemp[7] = f1[i + 7 * size];
-				if(trilocal[7] == 1) ftemp[8] = ftemp[8] - g * (hlocal[0] + hlocal[8]) * (blocal[0] - blocal[8]) * factS * 0.25; else ftemp[8] = f1[i + 8 * size];
-
-				if(trilocal[0] == 2) ftemp[1] = ftemp[3];
-				if(trilocal[1] == 2) ftemp[2] = ftemp[4];
-				if(trilocal[2] == 2) ftemp[3] = ftemp[1];
-				if(trilocal[3] == 2) ftemp[4] = ftemp[2];
-				if(trilocal[4] == 2) ftemp[5] = ftemp[7];
-				if(trilocal[5] == 2) ftemp[6] = ftemp[8];
-				if(trilocal[6] == 2) ftemp[7] = ftemp[5];
-				if(trilocal[7] == 2) ftemp[8] = ftemp[6];
-			#elif BN == 2
-				ftemp[1] = (trilocal[0] == 1) ? (ftemp[1] - g * (hlocal[0] + hlocal[1]) * (blocal[0] - blocal[1]) * factS) : f1[i +     size];
-				ftemp[2] = (trilocal[1] == 1) ? (ftemp[2] - g * (hlocal[0] + hlocal[2]) * (blocal[0] - blocal[2]) * factS) : f1[i + 2 * size];
-				ftemp[3] = (trilocal[2] == 1) ? (ftemp[3] - g * (hlocal[0] + hlocal[3]) * (blocal[0] - blocal[3]) * factS) : f1[i + 3 * size];
-				ftemp[4] = (trilocal[3] == 1) ? (ftemp[4] - g * (hlocal[0] + hlocal[4]) * (blocal[0] - blocal[4]) * factS) : f1[i + 4 * size];
-				ftemp[5] = (trilocal[4] == 1) ? (ftemp[5] - g * (hlocal[0] + hlocal[5]) * (blocal[0] - blocal[5]) * factS * 0.25) : f1[i + 5 * size];
-				ftemp[6] = (trilocal[5] == 1) ? (ftemp[6] - g * (hlocal[0] + hlocal[6]) * (blocal[0] - blocal[6]) * factS * 0.25) : f1[i + 6 * size];
-				ftemp[7] = (trilocal[6] == 1) ? (ftemp[7] - g * (hlocal[0] + hlocal[7]) * (blocal[0] - blocal[7]) * factS * 0.25) : f1[i + 7 * size];
-				ftemp[8] = (trilocal[7] == 1) ? (ftemp[8] - g * (hlocal[0] + hlocal[8]) * (blocal[0] - blocal[8]) * factS * 0.25) : f1[i + 8 * size];
-
-				ftemp[1] = (trilocal[0] == 2) ? ftemp[3] : ftemp[1];
-				ftemp[2] = (trilocal[1] == 2) ? ftemp[4] : ftemp[2];
-				ftemp[3] = (trilocal[2] == 2) ? ftemp[1] : ftemp[3];
-				ftemp[4] = (trilocal[3] == 2) ? ftemp[2] : ftemp[4];
-				ftemp[5] = (trilocal[4] == 2) ? ftemp[7] : ftemp[5];
-				ftemp[6] = (trilocal[5] == 2) ? ftemp[8] : ftemp[6];
-				ftemp[7] = (trilocal[6] == 2) ? ftemp[5] : ftemp[7];
-				ftemp[8] = (trilocal[7] == 2) ? ftemp[6] : ftemp[8];
-			#else
-				ftemp[1] = (trilocal[0] == 1) * (ftemp[1] - g * (hlocal[0] + hlocal[1]) * (blocal[0] - blocal[1]) * factS) + (trilocal[0] != 1) * f1[i +     size];
-				ftemp[2] = (trilocal[1] == 1) * (ftemp[2] - g * (hlocal[0] + hlocal[2]) * (blocal[0] - blocal[2]) * factS) + (trilocal[1] != 1) * f1[i + 2 * size];
-				ftemp[3] = (trilocal[2] == 1) * (ftemp[3] - g * (hlocal[0] + hlocal[3]) * (blocal[0] - blocal[3]) * factS) + (trilocal[2] != 1) * f1[i + 3 * size];
-				ftemp[4] = (trilocal[3] == 1) * (ftemp[4] - g * (hlocal[0] + hlocal[4]) * (blocal[0] - blocal[4]) * factS) + (trilocal[3] != 1) * f1[i + 4 * size];
-				ftemp[5] = (trilocal[4] == 1) * (ftemp[5] - g * (hlocal[0] + hlocal[5]) * (blocal[0] - blocal[5]) * factS * 0.25) + (trilocal[4] != 1) * f1[i + 5 * size];
-				ftemp[6] = (trilocal[5] == 1) * (ftemp[6] - g * (hlocal[0] + hlocal[6]) * (blocal[0] - blocal[6]) * factS * 0.25) + (trilocal[5] != 1) * f1[i + 6 * size];
-				ftemp[7] = (trilocal[6] == 1) * (ftemp[7] - g * (hlocal[0] + hlocal[7]) * (blocal[0] - blocal[7]) * factS * 0.25) + (trilocal[6] != 1) * f1[i + 7 * size];
-				ftemp[8] = (trilocal[7] == 1) * (ftemp[8] - g * (hlocal[0] + hlocal[8]) * (blocal[0] - blocal[8]) * factS * 0.25) + (trilocal[7] != 1) * f1[i + 8 * size];
-
-				ftemp[1] += (trilocal[0] == 2) * (ftemp[3] - ftemp[1]);
-				ftemp[2] += (trilocal[1] == 2) * (ftemp[4] - ftemp[2]);
-				ftemp[3] += (trilocal[2] == 2) * (ftemp[1] - ftemp[3]);
-				ftemp[4] += (trilocal[3] == 2) * (ftemp[2] - ftemp[4]);
-				ftemp[5] += (trilocal[4] == 2) * (ftemp[7] - ftemp[5]);
-				ftemp[6] += (trilocal[5] == 2) * (ftemp[8] - ftemp[6]);
-				ftemp[7] += (trilocal[6] == 2) * (ftemp[5] - ftemp[7]);
-				ftemp[8] += (trilocal[7] == 2) * (ftemp[6] - ftemp[8]);
-			#endif
-
-			hlocal[0] = ftemp[0] + (ftemp[1] + ftemp[2] + ftemp[3] + ftemp[4]) + (ftemp[5] + ftemp[6] + ftemp[7] + ftemp[8]);
-			uxlocal = e * ((ftemp[1] - ftemp[3]) + (ftemp[5] - ftemp[6] - ftemp[7] + ftemp[8])) / hlocal[0];
-			uylocal = e * ((ftemp[2] - ftemp[4]) + (ftemp[5] + ftemp[6] - ftemp[7] - ftemp[8])) / hlocal[0];
-
-			h[i] = hlocal[0];
-
-			gh = 1.5 * g * hlocal[0];
-			usq = 1.5 * (uxlocal * uxlocal + uylocal * uylocal);
-			ux3 = 3.0 * e * uxlocal;
-			uy3 = 3.0 * e * uylocal;
-			uxuy5 = ux3 + uy3;
-			uxuy6 = uy3 - ux3;
-
-			feq[0] = hlocal[0] - fact1 * hlocal[0] * (5.0 * gh + 4.0 * usq);
-			feq[1] = fact1 * hlocal[0] * (gh + ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
-			feq[2] = fact1 * hlocal[0] * (gh + uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
-			feq[3] = fact1 * hlocal[0] * (gh - ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
-			feq[4] = fact1 * hlocal[0] * (gh - uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
-			feq[5] = fact2 * hlocal[0] * (gh + uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
-			feq[6] = fact2 * hlocal[0] * (gh + uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
-			feq[7] = fact2 * hlocal[0] * (gh - uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
-			feq[8] = fact2 * hlocal[0] * (gh - uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
-			for (j = 0; j < 9; j++)
-				f2[i + j * size] = ftemp[j] - (ftemp[j] - feq[j]) / tau;
-		}
+		if (k == 0)
+			wt[t] = wl;
+		int ex = POP16_MINEXP + 14;
+		if (dev > 0)
+			frexp(dev, &ex);
+		s[tk] = ldexpf(1.0f, (ex - 14 > POP16_MINEXP) ? ex - 14 : POP16_MINEXP);
 	}
-} 
-#elif IN == 2
-__global__ void LBMpull(int Lx, int Ly, prec g, prec e, prec tau,
-	const prec* __restrict__ b, const int* __restrict__ node_types,
-	const prec* __restrict__ f1, prec* f2, prec* h) {
-	int i = threadIdx.x + blockIdx.x*blockDim.x;
-	int size = Lx * Ly, j;
-	prec ftemp[9], feq[9];
-	prec uxlocal, uylocal;
-	prec hlocal[9], blocal[9];
-	prec gh, usq, ux3, uy3, uxuy5, uxuy6;
-	prec fact1 = 1 / (9 * e*e);
-	prec fact2 = fact1 * 0.25;
-	prec factS = fact1 * 1.5;
-	unsigned char trilocal[8]; 
-	int nt[9]; 
-	if (i < size) {
-		nt[0] = node_types[i];
-		if (nt[0] != 0){
-			int y = (int)i / Lx;
-			int x = i - y * Lx;
-
-			blocal[0] = b[i];
-			blocal[1] = (             x != 0   ) ? b[i      - 1] : 0;
-			blocal[2] = (y != 0                ) ? b[i - Lx    ] : 0;
-			blocal[3] = (             x != Lx-1) ? b[i      + 1] : 0;
-			blocal[4] = (y != Ly-1             ) ? b[i + Lx    ] : 0;
-			blocal[5] = (y != 0    && x != 0   ) ? b[i - Lx - 1] : 0;
-			blocal[6] = (y != 0    && x != Lx-1) ? b[i - Lx + 1] : 0;
-			blocal[7] = (y != Ly-1 && x != Lx-1) ? b[i + Lx + 1] : 0;
-			blocal[8] = (y != Ly-1 && x != 0   ) ? b[i + Lx - 1] : 0;
-
-			hlocal[0] = h[i];
-			hlocal[1] = (             x != 0   ) ? h[i      - 1] : 0;
-			hlocal[2] = (y != 0                ) ? h[i - Lx    ] : 0;
-			hlocal[3] = (             x != Lx-1) ? h[i      + 1] : 0;
-			hlocal[4] = (y != Ly-1             ) ? h[i + Lx    ] : 0;
-			hlocal[5] = (y != 0    && x != 0   ) ? h[i - Lx - 1] : 0;
-			hlocal[6] = (y != 0    && x != Lx-1) ? h[i - Lx + 1] : 0;
-			hlocal[7] = (y != Ly-1 && x != Lx-1) ? h[i + Lx + 1] : 0;
-			hlocal[8] = (y != Ly-1 && x != 0   ) ? h[i + Lx - 1] : 0;
-
-			ftemp[1] = (             x != 0   ) ? f1[i      - 1 +     size] : 0;
-			ftemp[2] = (y != 0                ) ? f1[i - Lx     + 2 * size] : 0;
-			ftemp[3] = (             x != Lx-1) ? f1[i      + 1 + 3 * size] : 0;
-			ftemp[4] = (y != Ly-1             ) ? f1[i + Lx     + 4 * size] : 0;
-			ftemp[5] = (y != 0    && x != 0   ) ? f1[i - Lx - 1 + 5 * size] : 0;
-			ftemp[6] = (y != 0    && x != Lx-1) ? f1[i - Lx + 1 + 6 * size] : 0;
-			ftemp[7] = (y != Ly-1 && x != Lx-1) ? f1[i + Lx + 1 + 7 * size] : 0;
-			ftemp[8] = (y != Ly-1 && x != 0   ) ? f1[i + Lx - 1 + 8 * size] : 0;
-
-			for (int a = 0; a<8; a++) trilocal[a] = 0;
-			if (nt[0] == 2) {
-				if (y == 0) {
-					if (x == 0) {
-						trilocal[2] = 1;
-						trilocal[3] = 1;
-						trilocal[6] = 1;
-					}
-					else if (x == Lx - 1) {
-						trilocal[0] = 1;
-						trilocal[3] = 1;
-						trilocal[7] = 1;
-					}
-					else {
-						trilocal[0] = 1;
-						trilocal[2] = 1;
-						trilocal[3] = 1;
-						trilocal[6] = 1;
-						trilocal[7] = 1;
-					}
-				}
-				else if (y == Ly - 1) {
-					if (x == 0) {
-						trilocal[1] = 1;
-						trilocal[2] = 1;
-						trilocal[5] = 1;
-					}
-					else if (x == Lx - 1) {
-						trilocal[0] = 1;
-						trilocal[1] = 1;
-						trilocal[4] = 1;
-					}
-					else {
-						trilocal[0] = 1;
-						trilocal[1] = 1;
-						trilocal[2] = 1;
-						trilocal[4] = 1;
-						trilocal[5] = 1;
-					}
-				}
-				else {
-					if (x == 0) {
-						trilocal[1] = 1;
-						trilocal[2] = 1;
-						trilocal[3] = 1;
-						trilocal[5] = 1;
-						trilocal[6] = 1;
-					}
-					else if (x == Lx - 1) {
-						trilocal[0] = 1;
-						trilocal[1] = 1;
-						trilocal[3] = 1;
-						trilocal[4] = 1;
-						trilocal[7] = 1;
-					}
-					else {
-						for (int a = 0; a<8; a++) {
-							trilocal[a] = 1;
-						}
-					}
-				}
-			}
-			else if (nt[0] == 1) {
-				if (y == 0) {
-					trilocal[0] = 1;
-					trilocal[3] = 1;
-					trilocal[7] = 1;
-					trilocal[2] = 2;
-					trilocal[5] = 2;
-					trilocal[6] = 2;
-				}
-				else if (y == Ly - 1) {
-					trilocal[0] = 1;
-					trilocal[1] = 1;
-					trilocal[4] = 1;
-					trilocal[2] = 2;
-					trilocal[5] = 2;
-					trilocal[6] = 2;
-				}
-				else {
-					nt[1] = node_types[i - 1 ];
-					nt[2] = node_types[i - Lx];
-					nt[3] = node_types[i + 1 ];
-					nt[4] = node_types[i + Lx];
-					nt[5] = node_types[i - Lx - 1];
-					nt[6] = node_types[i - Lx + 1];
-					nt[7] = node_types[i + Lx + 1];
-					nt[8] = node_types[i + Lx - 1];
-					for (int a = 1; a<9; a++){
-						if (nt[a] != 0)
-							trilocal[a-1] = 1;
-						else
-							trilocal[a-1] = 2;
-					}
-					if (nt[5] == 0 || (nt[5] == 1 && (nt[1] == 0 || nt[2] == 0))) trilocal[4] = 2;
-					if (nt[6] == 0 || (nt[6] == 1 && (nt[2] == 0 || nt[3] == 0))) trilocal[5] = 2;
-					if (nt[7] == 0 || (nt[7] == 1 && (nt[3] == 0 || nt[4] == 0))) trilocal[6] = 2;
-					if (nt[8] == 0 || (nt[8] == 1 && (nt[4] == 0 || nt[1] == 0))) trilocal[7] = 2;
-				} 
-			}
+}
 
-			ftemp[0] = f1[i]; 
-			#if BN == 1
-				if(trilocal[0] == 1) ftemp[1] = ftemp[1] - g * (hlocal[0] + hlocal[1]) * (blocal[0] - blocal[1]) * factS; else ftemp[1] = f1[i +     size];
-				if(trilocal[1] == 1) ftemp[2] = ftemp[2] - g * (hlocal[0] + hlocal[2]) * (blocal[0] - blocal[2]) * factS; else ftemp[2] = f1[i + 2 * size];
-				if(trilocal[2] == 1) ftemp[3] = ftemp[3] - g * (hlocal[0] + hlocal[3]) * (blocal[0] - blocal[3]) * factS; else ftemp[3] = f1[i + 3 * size];
-				if(trilocal[3] == 1) ftemp[4] = ftemp[4] - g * (hlocal[0] + hlocal[4]) * (blocal[0] - blocal[4]) * factS; else ftemp[4] = f1[i + 4 * size];
-				if(trilocal[4] == 1) ftemp[5] = ftemp[5] - g * (hlocal[0] + hlocal[5]) * (blocal[0] - blocal[5]) * factS * 0.25; else ftemp[5] = f1[i + 5 * size];
-				if(trilocal[5] == 1) ftemp[6] = ftemp[6] - g * (hlocal[0] + hlocal[6]) * (blocal[0] - blocal[6]) * factS * 0.25; else ftemp[6] = f1[i + 6 * size];
-				if(trilocal[6] == 1) ftemp[7] = ftemp[7] - g * (hlocal[0] + hlocal[7]) * (blocal[0] - blocal[7]) * factS * 0.25; else ftemp[7] = f1[i + 7 * size];
-				if(trilocal[7] == 1) ftemp[8] = ftemp[8] - g * (hlocal[0] + hlocal[8]) * (blocal[0] - blocal[8]) * factS * 0.25; else ftemp[8] = f1[i + 8 * size];
-
-				if(trilocal[0] == 2) ftemp[1] = ftemp[3];
-				if(trilocal[1] == 2) ftemp[2] = ftemp[4];
-				if(trilocal[2] == 2) ftemp[3] = ftemp[1];
-				if(trilocal[3] == 2) ftemp[4] = ftemp[2];
-				if(trilocal[4] == 2) ftemp[5] = ftemp[7];
-				if(trilocal[5] == 2) ftemp[6] = ftemp[8];
-				if(trilocal[6] == 2) ftemp[7] = ftemp[5];
-				if(trilocal[7] == 2) ftemp[8] = ftemp[6];
-			#elif BN == 2
-				ftemp[1] = (trilocal[0] == 1) ? (ftemp[1] - g * (hlocal[0] + hlocal[1]) * (blocal[0] - blocal[1]) * factS) : f1[i +     size];
-				ftemp[2] = (trilocal[1] == 1) ? (ftemp[2] - g * (hlocal[0] + hlocal[2]) * (blocal[0] - blocal[2]) * factS) : f1[i + 2 * size];
-				ftemp[3] = (trilocal[2] == 1) ? (ftemp[3] - g * (hlocal[0] + hlocal[3]) * (blocal[0] - blocal[3]) * factS) : f1[i + 3 * size];
-				ftemp[4] = (trilocal[3] == 1) ? (ftemp[4] - g * (hlocal[0] + hlocal[4]) * (blocal[0] - blocal[4]) * factS) : f1[i + 4 * size];
-				ftemp[5] = (trilocal[4] == 1) ? (ftemp[5] - g * (hlocal[0] + hlocal[5]) * (blocal[0] - blocal[5]) * factS * 0.25) : f1[i + 5 * size];
-				ftemp[6] = (trilocal[5] == 1) ? (ftemp[6] - g * (hlocal[0] + hlocal[6]) * (blocal[0] - blocal[6]) * factS * 0.25) : f1[i + 6 * size];
-				ftemp[7] = (trilocal[6] == 1) ? (ftemp[7] - g * (hlocal[0] + hlocal[7]) * (blocal[0] - blocal[7]) * factS * 0.25) : f1[i + 7 * size];
-				ftemp[8] = (trilocal[7] == 1) ? (ftemp[8] - g * (hlocal[0] + hlocal[8]) * (blocal[0] - blocal[8]) * factS * 0.25) : f1[i + 8 * size];
-
-				ftemp[1] = (trilocal[0] == 2) ? ftemp[3] : ftemp[1];
-				ftemp[2] = (trilocal[1] == 2) ? ftemp[4] : ftemp[2];
-				ftemp[3] = (trilocal[2] == 2) ? ftemp[1] : ftemp[3];
-				ftemp[4] = (trilocal[3] == 2) ? ftemp[2] : ftemp[4];
-				ftemp[5] = (trilocal[4] == 2) ? ftemp[7] : ftemp[5];
-				ftemp[6] = (trilocal[5] == 2) ? ftemp[8] : ftemp[6];
-				ftemp[7] = (trilocal[6] == 2) ? ftemp[5] : ftemp[7];
-				ftemp[8] = (trilocal[7] == 2) ? ftemp[6] : ftemp[8];
-			#else
-				ftemp[1] = (trilocal[0] == 1) * (ftemp[1] - g * (hlocal[0] + hlocal[1]) * (blocal[0] - blocal[1]) * factS) + (trilocal[0] != 1) * f1[i +     size];
-				ftemp[2] = (trilocal[1] == 1) * (ftemp[2] - g * (hlocal[0] + hlocal[2]) * (blocal[0] - blocal[2]) * factS) + (trilocal[1] != 1) * f1[i + 2 * size];
-				ftemp[3] = (trilocal[2] == 1) * (ftemp[3] - g * (hlocal[0] + hlocal[3]) * (blocal[0] - blocal[3]) * factS) + (trilocal[2] != 1) * f1[i + 3 * size];
-				ftemp[4] = (trilocal[3] == 1) * (ftemp[4] - g * (hlocal[0] + hlocal[4]) * (blocal[0] - blocal[4]) * factS) + (trilocal[3] != 1) * f1[i + 4 * size];
-				ftemp[5] = (trilocal[4] == 1) * (ftemp[5] - g * (hlocal[0] + hlocal[5]) * (blocal[0] - blocal[5]) * factS * 0.25) + (trilocal[4] != 1) * f1[i + 5 * size];
-				ftemp[6] = (trilocal[5] == 1) * (ftemp[6] - g * (hlocal[0] + hlocal[6]) * (blocal[0] - blocal[6]) * factS * 0.25) + (trilocal[5] != 1) * f1[i + 6 * size];
-				ftemp[7] = (trilocal[6] == 1) * (ftemp[7] - g * (hlocal[0] + hlocal[7]) * (blocal[0] - blocal[7]) * factS * 0.25) + (trilocal[6] != 1) * f1[i + 7 * size];
-				ftemp[8] = (trilocal[7] == 1) * (ftemp[8] - g * (hlocal[0] + hlocal[8]) * (blocal[0] - blocal[8]) * factS * 0.25) + (trilocal[7] != 1) * f1[i + 8 * size];
-
-				ftemp[1] += (trilocal[0] == 2) * (ftemp[3] - ftemp[1]);
-				ftemp[2] += (trilocal[1] == 2) * (ftemp[4] - ftemp[2]);
-				ftemp[3] += (trilocal[2] == 2) * (ftemp[1] - ftemp[3]);
-				ftemp[4] += (trilocal[3] == 2) * (ftemp[2] - ftemp[4]);
-				ftemp[5] += (trilocal[4] == 2) * (ftemp[7] - ftemp[5]);
-				ftemp[6] += (trilocal[5] == 2) * (ftemp[8] - ftemp[6]);
-				ftemp[7] += (trilocal[6] == 2) * (ftemp[5] - ftemp[7]);
-				ftemp[8] += (trilocal[7] == 2) * (ftemp[6] - ftemp[8]);
-			#endif
-
-			hlocal[0] = ftemp[0] + (ftemp[1] + ftemp[2] + ftemp[3] + ftemp[4]) + (ftemp[5] + ftemp[6] + ftemp[7] + ftemp[8]);
-			uxlocal = e * ((ftemp[1] - ftemp[3]) + (ftemp[5] - ftemp[6] - ftemp[7] + ftemp[8])) / hlocal[0];
-			uylocal = e * ((ftemp[2] - ftemp[4]) + (ftemp[5] + ftemp[6] - ftemp[7] - ftemp[8])) / hlocal[0];
-
-			h[i] = hlocal[0];
-
-			gh = 1.5 * g * hlocal[0];
-			usq = 1.5 * (uxlocal * uxlocal + uylocal * uylocal);
-			ux3 = 3.0 * e * uxlocal;
-			uy3 = 3.0 * e * uylocal;
-			uxuy5 = ux3 + uy3;
-			uxuy6 = uy3 - ux3;
-
-			feq[0] = hlocal[0] - fact1 * hlocal[0] * (5.0 * gh + 4.0 * usq);
-			feq[1] = fact1 * hlocal[0] * (gh + ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
-			feq[2] = fact1 * hlocal[0] * (gh + uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
-			feq[3] = fact1 * hlocal[0] * (gh - ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
-			feq[4] = fact1 * hlocal[0] * (gh - uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
-			feq[5] = fact2 * hlocal[0] * (gh + uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
-			feq[6] = fact2 * hlocal[0] * (gh + uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
-			feq[7] = fact2 * hlocal[0] * (gh - uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
-			feq[8] = fact2 * hlocal[0] * (gh - uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
-			for (j = 0; j < 9; j++)
-				f2[i + j * size] = ftemp[j] - (ftemp[j] - feq[j]) / tau;
-		}
+// Scale of the next write from the flags of the step that used sWritten:
+// grow on demand, halve when no value reached POP16_KEEP
+__global__ void popScaleKernel(int NT9, const float* __restrict__ sWritten, float* sNext,
+	unsigned char* popFlags) {
+
+	int tk = threadIdx.x + blockIdx.x*blockDim.x;
+	if (tk < NT9) {
+		float s = sWritten[tk];
+		int grow = popFlags[2 * tk + 1];
+		if (grow != 0)
+			s = ldexpf(s, grow);
+		else if (popFlags[2 * tk] == 0 && ilogbf(s) > POP16_MINEXP)
+			s = s * 0.5f;
+		sNext[tk] = s;
+		popFlags[2 * tk] = 0;
+		popFlags[2 * tk + 1] = 0;
 	}
-} 
-#elif IN == 3
-__global__ void LBMpull(int Lx, int Ly, prec g, prec e, prec tau,
-	const prec* __restrict__ b, const unsigned char* __restrict__ Arr_tri, 
-	const prec* __restrict__ f1, prec* f2, prec* h) {
-	int i = threadIdx.x + blockIdx.x*blockDim.x;
-	int size = Lx * Ly, j;
-	prec ftemp[9], feq[9];
-	prec uxlocal, uylocal;
-	prec hlocal[9], blocal[9];
-	prec gh, usq, ux3, uy3, uxuy5, uxuy6;
-	prec fact1 = 1 / (9 * e*e);
-	prec fact2 = fact1 * 0.25;
-	prec factS = fact1 * 1.5;
-	unsigned char trilocal[8]; 
-	if (i < size) {			
-		int check = 0;
-		for (j = 1; j < 9; j++)
-			trilocal[j-1] = Arr_tri[i + j * size];
-		for (j = 0; j < 8; j++)
-			check += trilocal[j];
-		if (check != 0){
-			int y = (int)i / Lx;
-			int x = i - y * Lx;
-			blocal[0] = b[i];
-			blocal[1] = (             x != 0   ) ? b[i      - 1] : 0;
-			blocal[2] = (y != 0                ) ? b[i - Lx    ] : 0;
-			blocal[3] = (             x != Lx-1) ? b[i      + 1] : 0;
-			blocal[4] = (y != Ly-1             ) ? b[i + Lx    ] : 0;
-			blocal[5] = (y != 0    && x != 0   ) ? b[i - Lx - 1] : 0;
-			blocal[6] = (y != 0    && x != Lx-1) ? b[i - Lx + 1] : 0;
-			blocal[7] = (y != Ly-1 && x != Lx-1) ? b[i + Lx + 1] : 0; 
-			blocal[8] = (y != Ly-1 && x != 0   ) ? b[i + Lx - 1] : 0;
-
-			hlocal[0] = h[i];
-			hlocal[1] = (             x != 0   ) ? h[i      - 1] : 0;
-			hlocal[2] = (y != 0                ) ? h[i - Lx    ] : 0;
-			hlocal[3] = (             x != Lx-1) ? h[i      + 1] : 0;
-			hlocal[4] = (y != Ly-1             ) ? h[i + Lx    ] : 0;
-			hlocal[5] = (y != 0    && x != 0   ) ? h[i - Lx - 1] : 0;
-			hlocal[6] = (y != 0    && x != Lx-1) ? h[i - Lx + 1] : 0;
-			hlocal[7] = (y != Ly-1 && x != Lx-1) ? h[i + Lx + 1] : 0;
-			hlocal[8] = (y != Ly-1 && x != 0   ) ? h[i + Lx - 1] : 0;
-
-			ftemp[1] = (             x != 0   ) ? f1[i      - 1 +     size] : 0;
-			ftemp[2] = (y != 0                ) ? f1[i - Lx     + 2 * size] : 0;
-			ftemp[3] = (             x != Lx-1) ? f1[i      + 1 + 3 * size] : 0;
-			ftemp[4] = (y != Ly-1             ) ? f1[i + Lx     + 4 * size] : 0;
-			ftemp[5] = (y != 0    && x != 0   ) ? f1[i - Lx - 1 + 5 * size] : 0;
-			ftemp[6] = (y != 0    && x != Lx-1) ? f1[i - Lx + 1 + 6 * size] : 0;
-			ftemp[7] = (y != Ly-1 && x != Lx-1) ? f1[i + Lx + 1 + 7 * size] : 0;
-			ftemp[8] = (y != Ly-1 && x != 0   ) ? f1[i + Lx - 1 + 8 * size] : 0;
-
-			ftemp[0] = f1[i]; 
-			#if BN == 1
-				if(trilocal[0] == 1) ftemp[1] = ftemp[1] - g * (hlocal[0] + hlocal[1]) * (blocal[0] - blocal[1]) * factS; else ftemp[1] = f1[i +     size];
-				if(trilocal[1] == 1) ftemp[2] = ftemp[2] - g * (hlocal[0] + hlocal[2]) * (blocal[0] - blocal[2]) * factS; else ftemp[2] = f1[i + 2 * size];
-				if(trilocal[2] == 1) ftemp[3] = ftemp[3] - g * (hlocal[0] + hlocal[3]) * (blocal[0] - blocal[3]) * factS; else ftemp[3] = f1[i + 3 * size];
-				if(trilocal[3] == 1) ftemp[4] = ftemp[4] - g * (hlocal[0] + hlocal[4]) * (blocal[0] - blocal[4]) * factS; else ftemp[4] = f1[i + 4 * size];
-				if(trilocal[4] == 1) ftemp[5] = ftemp[5] - g * (hlocal[0] + hlocal[5]) * (blocal[0] - blocal[5]) * factS * 0.25; else ftemp[5] = f1[i + 5 * size];
-				if(trilocal[5] == 1) ftemp[6] = ftemp[6] - g * (hlocal[0] + hlocal[6]) * (blocal[0] - blocal[6]) * factS * 0.25; else ftemp[6] = f1[i + 6 * size];
-				if(trilocal[6] == 1) ftemp[7] = ftemp[7] - g * (hlocal[0] + hlocal[7]) * (blocal[0] - blocal[7]) * factS * 0.25; else ftemp[7] = f1[i + 7 * size];
-				if(trilocal[7] == 1) ftemp[8] = ftemp[8] - g * (hlocal[0] + hlocal[8]) * (blocal[0] - blocal[8]) * factS * 0.25; else ftemp[8] = f1[i + 8 * size];
-
-				if(trilocal[0] == 2) ftemp[1] = ftemp[3];
-				if(trilocal[1] == 2) ftemp[2] = ftemp[4];
-				if(trilocal[2] == 2) ftemp[3] = ftemp[1];
-				if(trilocal[3] == 2) ftemp[4] = ftemp[2];
-				if(trilocal[4] == 2) ftemp[5] = ftemp[7];
-				if(trilocal[5] == 2) ftemp[6] = ftemp[8];
-				if(trilocal[6] == 2) ftemp[7] = ftemp[5];
-				if(trilocal[7] == 2) ftemp[8] = ftemp[6];
-			#elif BN == 2
-				ftemp[1] = (trilocal[0] == 1) ? (ftemp[1] - g * (hlocal[0] + hlocal[1]) * (blocal[0] - blocal[1]) * factS) : f1[i +     size];
-				ftemp[2] = (trilocal[1] == 1) ? (ftemp[2] - g * (hlocal[0] + hlocal[2]) * (blocal[0] - blocal[2]) * factS) : f1[i + 2 * size];
-				ftemp[3] = (trilocal[2] == 1) ? (ftemp[3] - g * (hlocal[0] + hlocal[3]) * (blocal[0] - blocal[3]) * factS) : f1[i + 3 * size];
-				ftemp[4] = (trilocal[3] == 1) ? (ftemp[4] - g * (hlocal[0] + hlocal[4]) * (blocal[0] - blocal[4]) * factS) : f1[i + 4 * size];
-				ftemp[5] = (trilocal[4] == 1) ? (ftemp[5] - g * (hlocal[0] + hlocal[5]) * (blocal[0] - blocal[5]) * factS * 0.25) : f1[i + 5 * size];
-				ftemp[6] = (trilocal[5] == 1) ? (ftemp[6] - g * (hlocal[0] + hlocal[6]) * (blocal[0] - blocal[6]) * factS * 0.25) : f1[i + 6 * size];
-				ftemp[7] = (trilocal[6] == 1) ? (ftemp[7] - g * (hlocal[0] + hlocal[7]) * (blocal[0] - blocal[7]) * factS * 0.25) : f1[i + 7 * size];
-				ftemp[8] = (trilocal[7] == 1) ? (ftemp[8] - g * (hlocal[0] + hlocal[8]) * (blocal[0] - blocal[8]) * factS * 0.25) : f1[i + 8 * size];
-
-				ftemp[1] = (trilocal[0] == 2) ? ftemp[3] : ftemp[1];
-				ftemp[2] = (trilocal[1] == 2) ? ftemp[4] : ftemp[2];
-				ftemp[3] = (trilocal[2] == 2) ? ftemp[1] : ftemp[3];
-				ftemp[4] = (trilocal[3] == 2) ? ftemp[2] : ftemp[4];
-				ftemp[5] = (trilocal[4] == 2) ? ftemp[7] : ftemp[5];
-				ftemp[6] = (trilocal[5] == 2) ? ftemp[8] : ftemp[6];
-				ftemp[7] = (trilocal[6] == 2) ? ftemp[5] : ftemp[7];
-				ftemp[8] = (trilocal[7] == 2) ? ftemp[6] : ftemp[8];
-			#else
-				ftemp[1] = (trilocal[0] == 1) * (ftemp[1] - g * (hlocal[0] + hlocal[1]) * (blocal[0] - blocal[1]) * factS) + (trilocal[0] != 1) * f1[i +     size];
-				ftemp[2] = (trilocal[1] == 1) * (ftemp[2] - g * (hlocal[0] + hlocal[2]) * (blocal[0] - blocal[2]) * factS) + (trilocal[1] != 1) * f1[i + 2 * size];
-				ftemp[3] = (trilocal[2] == 1) * (ftemp[3] - g * (hlocal[0] + hlocal[3]) * (blocal[0] - blocal[3]) * factS) + (trilocal[2] != 1) * f1[i + 3 * size];
-				ftemp[4] = (trilocal[3] == 1) * (ftemp[4] - g * (hlocal[0] + hlocal[4]) * (blocal[0] - blocal[4]) * factS) + (trilocal[3] != 1) * f1[i + 4 * size];
-				ftemp[5] = (trilocal[4] == 1) * (ftemp[5] - g * (hlocal[0] + hlocal[5]) * (blocal[0] - blocal[5]) * factS * 0.25) + (trilocal[4] != 1) * f1[i + 5 * size];
-				ftemp[6] = (trilocal[5] == 1) * (ftemp[6] - g * (hlocal[0] + hlocal[6]) * (blocal[0] - blocal[6]) * factS * 0.25) + (trilocal[5] != 1) * f1[i + 6 * size];
-				ftemp[7] = (trilocal[6] == 1) * (ftemp[7] - g * (hlocal[0] + hlocal[7]) * (blocal[0] - blocal[7]) * factS * 0.25) + (trilocal[6] != 1) * f1[i + 7 * size];
-				ftemp[8] = (trilocal[7] == 1) * (ftemp[8] - g * (hlocal[0] + hlocal[8]) * (blocal[0] - blocal[8]) * factS * 0.25) + (trilocal[7] != 1) * f1[i + 8 * size];
-
-				ftemp[1] += (trilocal[0] == 2) * (ftemp[3] - ftemp[1]);
-				ftemp[2] += (trilocal[1] == 2) * (ftemp[4] - ftemp[2]);
-				ftemp[3] += (trilocal[2] == 2) * (ftemp[1] - ftemp[3]);
-				ftemp[4] += (trilocal[3] == 2) * (ftemp[2] - ftemp[4]);
-				ftemp[5] += (trilocal[4] == 2) * (ftemp[7] - ftemp[5]);
-				ftemp[6] += (trilocal[5] == 2) * (ftemp[8] - ftemp[6]);
-				ftemp[7] += (trilocal[6] == 2) * (ftemp[5] - ftemp[7]);
-				ftemp[8] += (trilocal[7] == 2) * (ftemp[6] - ftemp[8]);
-			#endif
-
-			hlocal[0] = ftemp[0] + (ftemp[1] + ftemp[2] + ftemp[3] + ftemp[4]) + (ftemp[5] + ftemp[6] + ftemp[7] + ftemp[8]);
-			uxlocal = e * ((ftemp[1] - ftemp[3]) + (ftemp[5] - ftemp[6] - ftemp[7] + ftemp[8])) / hlocal[0];
-			uylocal = e * ((ftemp[2] - ftemp[4]) + (ftemp[5] + ftemp[6] - ftemp[7] - ftemp[8])) / hlocal[0];
-
-			h[i] = hlocal[0];
-
-			gh = 1.5 * g * hlocal[0];
-			usq = 1.5 * (uxlocal * uxlocal + uylocal * uylocal);
-			ux3 = 3.0 * e * uxlocal;
-			uy3 = 3.0 * e * uylocal;
-			uxuy5 = ux3 + uy3;
-			uxuy6 = uy3 - ux3;
-
-			feq[0] = hlocal[0] - fact1 * hlocal[0] * (5.0 * gh + 4.0 * usq);
-			feq[1] = fact1 * hlocal[0] * (gh + ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
-			feq[2] = fact1 * hlocal[0] * (gh + uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
-			feq[3] = fact1 * hlocal[0] * (gh - ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
-			feq[4] = fact1 * hlocal[0] * (gh - uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
-			feq[5] = fact2 * hlocal[0] * (gh + uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
-			feq[6] = fact2 * hlocal[0] * (gh + uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
-			feq[7] = fact2 * hlocal[0] * (gh - uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
-			feq[8] = fact2 * hlocal[0] * (gh - uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
-			for (j = 0; j < 9; j++)
-				f2[i + j * size] = ftemp[j] - (ftemp[j] - feq[j]) / tau;
-		}
-	}
-} 
-#else
-__global__ void LBMpull(int Lx, int Ly, prec g, prec e, prec tau,
-	const prec* __restrict__ b, const unsigned char* __restrict__ SC_bin, 
-	const unsigned char* __restrict__ BB_bin, const prec* __restrict__ f1, 
-	prec* f2, prec* h) {
-	int i = threadIdx.x + blockIdx.x*blockDim.x;			
-	int size = Lx * Ly, j;
-	prec ftemp[9], feq[9];
-	prec uxlocal, uylocal;
-	prec hlocal[9], blocal[9];
-	prec gh, usq, ux3, uy3, uxuy5, uxuy6;
-	prec fact1 = 1 / (9 * e*e);
-	prec fact2 = fact1 * 0.25;
-	prec factS = fact1 * 1.5;
-	unsigned char SC,BB; 
-	if (i < size) {
-		SC = SC_bin[i];
-		BB = BB_bin[i];
-		if(SC + BB != 0){
-			int y = (int)i / Lx;
-			int x = i - y * Lx;
-			blocal[0] = b[i];
-			blocal[1] = (             x != 0   ) ? b[i      - 1] : 0;
-			blocal[2] = (y != 0                ) ? b[i - Lx    ] : 0;
-			blocal[3] = (             x != Lx-1) ? b[i      + 1] : 0;
-			blocal[4] = (y != Ly-1             ) ? b[i + Lx    ] : 0;
-			blocal[5] = (y != 0    && x != 0   ) ? b[i - Lx - 1] : 0;
-			blocal[6] = (y != 0    && x != Lx-1) ? b[i - Lx + 1] : 0;
-			blocal[7] = (y != Ly-1 && x != Lx-1) ? b[i + Lx + 1] : 0; 
-			blocal[8] = (y != Ly-1 && x != 0   ) ? b[i + Lx - 1] : 0;
-
-			hlocal[0] = h[i];
-			hlocal[1] = (             x != 0   ) ? h[i      - 1] : 0;
-			hlocal[2] = (y != 0                ) ? h[i - Lx    ] : 0;
-			hlocal[3] = (             x != Lx-1) ? h[i      + 1] : 0; 
-			hlocal[4] = (y != Ly-1             ) ? h[i + Lx    ] : 0;
-			hlocal[5] = (y != 0    && x != 0   ) ? h[i - Lx - 1] : 0;
-			hlocal[6] = (y != 0    && x != Lx-1) ? h[i - Lx + 1] : 0;
-			hlocal[7] = (y != Ly-1 && x != Lx-1) ? h[i + Lx + 1] : 0;
-			hlocal[8] = (y != Ly-1 && x != 0   ) ? h[i + Lx - 1] : 0;
-
-			ftemp[1] = (             x != 0   ) ? f1[i      - 1 +     size] : 0;
-			ftemp[2] = (y != 0                ) ? f1[i - Lx     + 2 * size] : 0;
-			ftemp[3] = (             x != Lx-1) ? f1[i      + 1 + 3 * size] : 0;
-			ftemp[4] = (y != Ly-1             ) ? f1[i + Lx     + 4 * size] : 0;
-			ftemp[5] = (y != 0    && x != 0   ) ? f1[i - Lx - 1 + 5 * size] : 0;
-			ftemp[6] = (y != 0    && x != Lx-1) ? f1[i - Lx + 1 + 6 * size] : 0;
-			ftemp[7] = (y != Ly-1 && x != Lx-1) ? f1[i + Lx + 1 + 7 * size] : 0;
-			ftemp[8] = (y != Ly-1 && x != 0   ) ? f1[i + Lx - 1 + 8 * size] : 0;
-
-			ftemp[0] = f1[i]; 
-			#if BN == 1
-				if((SC>>0) & 1) ftemp[1] = ftemp[1] - g * (hlocal[0] + hlocal[1]) * (blocal[0] - blocal[1]) * factS; else ftemp[1] = f1[i +     size];
-				if((SC>>1) & 1) ftemp[2] = ftemp[2] - g * (hlocal[0] + hlocal[2]) * (blocal[0] - blocal[2]) * factS; else ftemp[2] = f1[i + 2 * size];
-				if((SC>>2) & 1) ftemp[3] = ftemp[3] - g * (hlocal[0] + hlocal[3]) * (blocal[0] - blocal[3]) * factS; else ftemp[3] = f1[i + 3 * size];
-				if((SC>>3) & 1) ftemp[4] = ftemp[4] - g * (hlocal[0] + hlocal[4]) * (blocal[0] - blocal[4]) * factS; else ftemp[4] = f1[i + 4 * size];
-				if((SC>>4) & 1) ftemp[5] = ftemp[5] - g * (hlocal[0] + hlocal[5]) * (blocal[0] - blocal[5]) * factS * 0.25; else ftemp[5] = f1[i + 5 * size];
-				if((SC>>5) & 1) ftemp[6] = ftemp[6] - g * (hlocal[0] + hlocal[6]) * (blocal[0] - blocal[6]) * factS * 0.25; else ftemp[6] = f1[i + 6 * size];
-				if((SC>>6) & 1) ftemp[7] = ftemp[7] - g * (hlocal[0] + hlocal[7]) * (blocal[0] - blocal[7]) * factS * 0.25; else ftemp[7] = f1[i + 7 * size];
-				if((SC>>7) & 1) ftemp[8] = ftemp[8] - g * (hlocal[0] + hlocal[8]) * (blocal[0] - blocal[8]) * factS * 0.25; else ftemp[8] = f1[i + 8 * size];
-
-				if((BB>>(0)) & 1) ftemp[1] = ftemp[3];
-				if((BB>>(1)) & 1) ftemp[2] = ftemp[4];
-				if((BB>>(2)) & 1) ftemp[3] = ftemp[1];
-				if((BB>>(3)) & 1) ftemp[4] = ftemp[2];
-				if((BB>>(4)) & 1) ftemp[5] = ftemp[7];
-				if((BB>>(5)) & 1) ftemp[6] = ftemp[8];
-				if((BB>>(6)) & 1) ftemp[7] = ftemp[5];
-				if((BB>>(7)) & 1) ftemp[8] = ftemp[6];
-			#elif BN == 2
-				ftemp[1] = ((SC>>0) & 1) ? (ftemp[1] - g * (hlocal[0] + hlocal[1]) * (blocal[0] - blocal[1]) * factS) : f1[i +     size];
-				ftemp[2] = ((SC>>1) & 1) ? (ftemp[2] - g * (hlocal[0] + hlocal[2]) * (blocal[0] - blocal[2]) * factS) : f1[i + 2 * size];
-				ftemp[3] = ((SC>>2) & 1) ? (ftemp[3] - g * (hlocal[0] + hlocal[3]) * (blocal[0] - blocal[3]) * factS) : f1[i + 3 * size];
-				ftemp[4] = ((SC>>3) & 1) ? (ftemp[4] - g * (hlocal[0] + hlocal[4]) * (blocal[0] - blocal[4]) * factS) : f1[i + 4 * size];
-				ftemp[5] = ((SC>>4) & 1) ? (ftemp[5] - g * (hlocal[0] + hlocal[5]) * (blocal[0] - blocal[5]) * factS * 0.25) : f1[i + 5 * size];
-				ftemp[6] = ((SC>>5) & 1) ? (ftemp[6] - g * (hlocal[0] + hlocal[6]) * (blocal[0] - blocal[6]) * factS * 0.25) : f1[i + 6 * size];
-				ftemp[7] = ((SC>>6) & 1) ? (ftemp[7] - g * (hlocal[0] + hlocal[7]) * (blocal[0] - blocal[7]) * factS * 0.25) : f1[i + 7 * size];
-				ftemp[8] = ((SC>>7) & 1) ? (ftemp[8] - g * (hlocal[0] + hlocal[8]) * (blocal[0] - blocal[8]) * factS * 0.25) : f1[i + 8 * size];
-
-				ftemp[1] = ((BB>>(0)) & 1) ? ftemp[3] : ftemp[1];
-				ftemp[2] = ((BB>>(1)) & 1) ? ftemp[4] : ftemp[2];
-				ftemp[3] = ((BB>>(2)) & 1) ? ftemp[1] : ftemp[3];
-				ftemp[4] = ((BB>>(3)) & 1) ? ftemp[2] : ftemp[4];
-				ftemp[5] = ((BB>>(4)) & 1) ? ftemp[7] : ftemp[5];
-				ftemp[6] = ((BB>>(5)) & 1) ? ftemp[8] : ftemp[6];
-				ftemp[7] = ((BB>>(6)) & 1) ? ftemp[5] : ftemp[7];
-				ftemp[8] = ((BB>>(7)) & 1) ? ftemp[6] : ftemp[8]; 
-			#else
-				//int x = i%Lx, y = i/Lx;
-				ftemp[1] = ((SC>>0) & 1) * (ftemp[1] - g * (hlocal[0] + hlocal[1]) * (blocal[0] - blocal[1]) * factS       ) + !((SC>>0) & 1) * f1[i +     size];
-				ftemp[2] = ((SC>>1) & 1) * (ftemp[2] - g * (hlocal[0] + hlocal[2]) * (blocal[0] - blocal[2]) * factS       ) + !((SC>>1) & 1) * f1[i + 2 * size];
-				ftemp[3] = ((SC>>2) & 1) * (ftemp[3] - g * (hlocal[0] + hlocal[3]) * (blocal[0] - blocal[3]) * factS       ) + !((SC>>2) & 1) * f1[i + 3 * size];
-				ftemp[4] = ((SC>>3) & 1) * (ftemp[4] - g * (hlocal[0] + hlocal[4]) * (blocal[0] - blocal[4]) * factS       ) + !((SC>>3) & 1) * f1[i + 4 * size];
-				ftemp[5] = ((SC>>4) & 1) * (ftemp[5] - g * (hlocal[0] + hlocal[5]) * (blocal[0] - blocal[5]) * factS * 0.25) + !((SC>>4) & 1) * f1[i + 5 * size];
-				ftemp[6] = ((SC>>5) & 1) * (ftemp[6] - g * (hlocal[0] + hlocal[6]) * (blocal[0] - blocal[6]) * factS * 0.25) + !((SC>>5) & 1) * f1[i + 6 * size];
-				ftemp[7] = ((SC>>6) & 1) * (ftemp[7] - g * (hlocal[0] + hlocal[7]) * (blocal[0] - blocal[7]) * factS * 0.25) + !((SC>>6) & 1) * f1[i + 7 * size];
-				ftemp[8] = ((SC>>7) & 1) * (ftemp[8] - g * (hlocal[0] + hlocal[8]) * (blocal[0] - blocal[8]) * factS * 0.25) + !((SC>>7) & 1) * f1[i + 8 * size];
-
-				ftemp[1] += ((BB>>(0)) & 1) * (ftemp[3] - ftemp[1]);
-				ftemp[2] += ((BB>>(1)) & 1) * (ftemp[4] - ftemp[2]);
-				ftemp[3] += ((BB>>(2)) & 1) * (ftemp[1] - ftemp[3]);
-				ftemp[4] += ((BB>>(3)) & 1) * (ftemp[2] - ftemp[4]); 
-				ftemp[5] += ((BB>>(4)) & 1) * (ftemp[7] - ftemp[5]);
-				ftemp[6] += ((BB>>(5)) & 1) * (ftemp[8] - ftemp[6]);
-				ftemp[7] += ((BB>>(6)) & 1) * (ftemp[5] - ftemp[7]);
-				ftemp[8] += ((BB>>(7)) & 1) * (ftemp[6] - ftemp[8]);
-			#endif
-
-			hlocal[0] = ftemp[0] + (ftemp[1] + ftemp[2] + ftemp[3] + ftemp[4]) + (ftemp[5] + ftemp[6] + ftemp[7] + ftemp[8]);
-			uxlocal = e * ((ftemp[1] - ftemp[3]) + (ftemp[5] - ftemp[6] - ftemp[7] + ftemp[8])) / hlocal[0];
-			uylocal = e * ((ftemp[2] - ftemp[4]) + (ftemp[5] + ftemp[6] - ftemp[7] - ftemp[8])) / hlocal[0];
-
-			h[i] = hlocal[0];
-
-			gh = 1.5 * g * hlocal[0];
-			usq = 1.5 * (uxlocal * uxlocal + uylocal * uylocal);
-			ux3 = 3.0 * e * uxlocal;
-			uy3 = 3.0 * e * uylocal;
-			uxuy5 = ux3 + uy3;
-			uxuy6 = uy3 - ux3;
-
-			feq[0] = hlocal[0] - fact1 * hlocal[0] * (5.0 * gh + 4.0 * usq);
-			feq[1] = fact1 * hlocal[0] * (gh + ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
-			feq[2] = fact1 * hlocal[0] * (gh + uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
-			feq[3] = fact1 * hlocal[0] * (gh - ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
-			feq[4] = fact1 * hlocal[0] * (gh - uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
-			feq[5] = fact2 * hlocal[0] * (gh + uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
-			feq[6] = fact2 * hlocal[0] * (gh + uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
-			feq[7] = fact2 * hlocal[0] * (gh - uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
-			feq[8] = fact2 * hlocal[0] * (gh - uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
-			for (j = 0; j < 9; j++)
-				f2[i + j * size] = ftemp[j] - (ftemp[j] - feq[j]) / tau;
-		}
-	} 
-} 
+}
 #endif
 
-__global__ void feqKernel(int Lx, int Ly, prec g, prec e,
-	const prec* __restrict__ h, prec* f) {
-
-	int i = threadIdx.x + blockIdx.x*blockDim.x;
-	if (i < Lx*Ly) {   // f0 f0 f0 f0 ... f1 f1 f1 f1 f1 .. f2 f2 f2 f2 f2 .... f3 f3 f3 f3 f3 .....
-		prec hi = h[i];
+#if LAZY
+// Nodes on the border ring of an active tile wake up the neighbouring tiles
+// once their populations leave the rest state set up by feqKernel.
+__global__ void activityKernel(int Lx, int Ly, prec g, prec e, prec tol,
+	const int* __restrict__ node_types, const prec* __restrict__ h0,
+	const prec* __restrict__ f, unsigned char* active) {
+
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	idx size = (idx)Lx * Ly;
+	if (i < size && node_types[i] != 0 && active[tileIndex(i, Lx)]) {
+		int y = i / Lx;
+		int x = i - (idx)y * Lx;
+		int lx = x % TILE, ly = y % TILE;
+		if (lx != 0 && lx != TILE - 1 && ly != 0 && ly != TILE - 1)
+			return;
+		prec hi = h0[i];
 		prec gh1 = g * hi * hi / (6.0 * e * e);
 		prec gh2 = gh1 / 4;
-		f[i] = hi - 5.0 * gh1;
-		f[i + (    Lx*Ly)] = gh1;
-		f[i + (2 * Lx*Ly)] = gh1;
-		f[i + (3 * Lx*Ly)] = gh1;
-		f[i + (4 * Lx*Ly)] = gh1;
-		f[i + (5 * Lx*Ly)] = gh2;
-		f[i + (6 * Lx*Ly)] = gh2;
-		f[i + (7 * Lx*Ly)] = gh2;
-		f[i + (8 * Lx*Ly)] = gh2;
+		prec dev = fabs(f[i] - (hi - 5.0 * gh1));
+		for (int j = 1; j < 5; j++)
+			dev = fmax(dev, fabs(f[i + j * size] - gh1));
+		for (int j = 5; j < 9; j++)
+			dev = fmax(dev, fabs(f[i + j * size] - gh2));
+		if (dev > tol) {
+			int NTx = (Lx + TILE - 1) / TILE, NTy = (Ly + TILE - 1) / TILE;
+			int tx = x / TILE, ty = y / TILE;
+			for (int tyi = ty - 1; tyi <= ty + 1; tyi++)
+				for (int txi = tx - 1; txi <= tx + 1; txi++)
+					if (txi >= 0 && txi < NTx && tyi >= 0 && tyi < NTy)
+						active[txi + tyi * NTx] = 1;
+		}
 	}
 }
+#endif
 
 __global__ void TSkernel(prec* TSdata, const prec* __restrict__ w,
-	const int* __restrict__ TSind, int t, int deltaTS, int NTS, int TTS) {
+	const idx* __restrict__ TSind, int t, int deltaTS, int NTS, int TTS) {
 	int i = threadIdx.x + blockIdx.x*blockDim.x;
 	if (i < NTS) {
 		int n = t / deltaTS;
-		TSdata[i*TTS + n] = w[TSind[i]];
+		TSdata[(size_t)i*TTS + n] = w[TSind[i]];
 	}
 }
 
  
-void LBMTimeStep(mainDStruct devi, cudaStruct devEx, int t, int deltaTS, hipEvent_t ct1, hipEvent_t ct2, prec *msecs) {
-	float dt;
+#if LAZY
+	#define LAZY_ARG , devEx.active
+#else
+	#define LAZY_ARG
+#endif
 
-	if (t % 2 == 0){
-		hipEventRecord(ct1);
-		#if IN == 1
-			hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.tau,
-			devi.b, devEx.f1, devEx.f2, devEx.h);
-		#elif IN == 2
-			hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.tau,
-			devi.b, devi.node_types, devEx.f1, devEx.f2, devEx.h);
-		#elif IN == 3
-			hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.tau,
-			devi.b, devEx.Arr_tri, devEx.f1, devEx.f2, devEx.h);
-		#else
-			hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.tau,
-			devi.b, devEx.SC_bin, devEx.BB_bin, devEx.f1, devEx.f2, devEx.h);
-		#endif
-	}
-	else{
-		hipEventRecord(ct1);
-		#if IN == 1
-			hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.tau,
-			devi.b, devEx.f2, devEx.f1, devEx.h);
-		#elif IN == 2
-			hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.tau,
-			devi.b, devi.node_types, devEx.f2, devEx.f1, devEx.h);
-		#elif IN == 3
-			hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.tau,
-			devi.b, devEx.Arr_tri, devEx.f2, devEx.f1, devEx.h);
-		#else
-			hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.tau,
-			devi.b, devEx.SC_bin, devEx.BB_bin, devEx.f2, devEx.f1, devEx.h);
-		#endif
+#if POP16
+	#define POP16_ARG , ssrc, sdst, devEx.popFlags, devEx.wt
+#else
+	#define POP16_ARG
+#endif
+
+#if OOC
+	#ifndef HIP_HOST
+		#error "OOC needs the host build (make host OOC=1)"
+	#endif
+	#define OOC_ARG , (idx)0, (idx)devi.Lx * devi.Ly
+#else
+	#define OOC_ARG
+#endif
+
+#if SLOPE
+	#define SLOPE_ARG devEx.slope
+	#define SLOPE_OPT , devEx.slope
+#else
+	#define SLOPE_ARG (sprec*)NULL
+	#define SLOPE_OPT
+#endif
+
+#if IN == 1
+	#define LBMpull LBMpullDepth<BN>
+#elif IN == 2
+	#define LBMpull LBMpullTypes<BN>
+#elif IN == 3
+	#define LBMpull LBMpullTri<BN>
+#elif IN == 4
+	#define LBMpull LBMpullBin<BN>
+#else
+	#define LBMpull LBMpullWord<BN>
+#endif
+
+void LBMpullLaunch(mainDStruct devi, cudaStruct devEx, int t) {
+	pop* fsrc = (t % 2 == 0) ? devEx.f1 : devEx.f2;
+	pop* fdst = (t % 2 == 0) ? devEx.f2 : devEx.f1;
+	#if POP16
+		float* ssrc = (t % 2 == 0) ? devEx.s1 : devEx.s2;
+		float* sdst = (t % 2 == 0) ? devEx.s2 : devEx.s1;
+	#endif
+	#if IN == 1
+		hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.coll,
+		devi.b, SLOPE_ARG, fsrc, fdst, devEx.h LAZY_ARG POP16_ARG);
+	#elif IN == 2
+		hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.coll,
+		devi.b, SLOPE_ARG, devi.node_types, fsrc, fdst, devEx.h LAZY_ARG POP16_ARG);
+	#elif IN == 3
+		hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.coll,
+		devi.b, SLOPE_ARG, devEx.Arr_tri, fsrc, fdst, devEx.h LAZY_ARG POP16_ARG);
+	#elif SPARSE
+		hipLaunchKernelGGL(LBMpullSparse<BN>, dim3(int(((size_t)devEx.Ntiles * TILE * TILE + devi.Nblocks - 1) / devi.Nblocks)), dim3(devi.Nblocks), 0, 0,
+		devEx.Ntiles, devEx.g, devEx.e, devEx.coll, devEx.tileNbr, devEx.bt, devEx.SC_bin, devEx.BB_bin, fsrc, fdst, devEx.h);
+	#elif ORDER
+		hipLaunchKernelGGL(LBMpullOrdered<BN>, dim3(int(((size_t)devEx.order.size + devi.Nblocks - 1) / devi.Nblocks)), dim3(devi.Nblocks), 0, 0,
+		devEx.order, devEx.g, devEx.e, devEx.coll, devEx.bt, devEx.SC_bin, devEx.BB_bin, fsrc, fdst, devEx.h);
+	#elif IN == 4
+		hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.coll,
+		devi.b, SLOPE_ARG, devEx.SC_bin, devEx.BB_bin, fsrc, fdst, devEx.h LAZY_ARG POP16_ARG OOC_ARG);
+	#elif SPLIT
+		if (devEx.Nbulk > 0)
+			hipLaunchKernelGGL(LBMpullBulk, dim3(int((devEx.Nbulk + devi.Nblocks - 1) / devi.Nblocks)), dim3(devi.Nblocks), 0, 0,
+			devi.Lx, devi.Ly, devEx.Nbulk, devEx.g, devEx.e, devEx.coll, devi.b SLOPE_OPT, devEx.bulk, fsrc, fdst, devEx.h POP16_ARG);
+		if (devEx.Nbnd > 0)
+			hipLaunchKernelGGL(LBMpull, dim3(int((devEx.Nbnd + devi.Nblocks - 1) / devi.Nblocks)), dim3(devi.Nblocks), 0, 0,
+			devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.coll, devi.b, SLOPE_ARG, devEx.SCBB_bin, fsrc, fdst, devEx.h POP16_ARG,
+			devEx.bnd, devEx.Nbnd);
+	#else
+		hipLaunchKernelGGL(LBMpull, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.coll,
+		devi.b, SLOPE_ARG, devEx.SCBB_bin, fsrc, fdst, devEx.h LAZY_ARG POP16_ARG);
+	#endif
+	#if POP16
+		// fsrc is written next, with the scales set from this step's flags
+		int NT9 = 9 * ((devi.Lx + TILE - 1) / TILE) * ((devi.Ly + TILE - 1) / TILE);
+		hipLaunchKernelGGL(popScaleKernel, dim3((NT9 + devi.Nblocks - 1) / devi.Nblocks), dim3(devi.Nblocks), 0, 0,
+		NT9, sdst, ssrc, devEx.popFlags);
+	#endif
+}
+
+// Advances every patch by one coarse step: ratio fine sub-steps with the ring
+// driven from the coarse level, then the patch interior is restricted back.
+void patchTimeStep(mainDStruct devi, cudaStruct devEx, patchStruct* patches, int NP, int t) {
+	#if POP16
+		// main rejects patches, the refinement kernels exchange prec populations
+		return;
+	#else
+	prec* fOld = (t % 2 == 0) ? devEx.f1 : devEx.f2;
+	prec* fNew = (t % 2 == 0) ? devEx.f2 : devEx.f1;
+	for (int p = 0; p < NP; p++) {
+		mainDStruct pdevi = patches[p].devi;
+		cudaStruct pdevEx = patches[p].devEx;
+		int ratio = patches[p].ratio;
+		int Nring = 2 * pdevi.Lx + 2 * (pdevi.Ly - 2);
+		int Ninner = ((pdevi.Lx - 1) / ratio - 1) * ((pdevi.Ly - 1) / ratio - 1);
+		int tf = t * ratio;
+		for (int s = 0; s < ratio; s++, tf++) {
+			LBMpullLaunch(pdevi, pdevEx, tf);
+			hipLaunchKernelGGL(coarseToFineKernel, dim3((Nring + pdevi.Nblocks - 1) / pdevi.Nblocks), dim3(pdevi.Nblocks), 0, 0,
+			devi.Lx, devi.Ly, pdevi.Lx, pdevi.Ly, ratio, patches[p].ox, patches[p].oy, patches[p].alphaC2F,
+			(prec)(s + 1) / ratio, devEx.g, devEx.e, devi.node_types, pdevi.node_types, fOld, fNew,
+			(tf % 2 == 0) ? pdevEx.f2 : pdevEx.f1, pdevEx.h);
+		}
+		hipLaunchKernelGGL(fineToCoarseKernel, dim3((Ninner + pdevi.Nblocks - 1) / pdevi.Nblocks), dim3(pdevi.Nblocks), 0, 0,
+		devi.Lx, devi.Ly, pdevi.Lx, pdevi.Ly, ratio, patches[p].ox, patches[p].oy, patches[p].alphaF2C,
+		devEx.g, devEx.e, devi.node_types, pdevi.node_types, ((tf - 1) % 2 == 0) ? pdevEx.f2 : pdevEx.f1,
+		fNew, devEx.h);
 	}
+	#endif
+}
 
+void wLaunch(mainDStruct devi, cudaStruct devEx) {
+	#if SPARSE
+		hipLaunchKernelGGL(sparseWKernel, dim3(int(((size_t)devEx.Ntiles * TILE * TILE + devi.Nblocks - 1) / devi.Nblocks)), dim3(devi.Nblocks), 0, 0,
+		devi.Lx, devi.Ly, devEx.Ntiles, devEx.tileXY, devEx.h, devEx.bt, devi.w);
+	#elif ORDER
+		hipLaunchKernelGGL(orderWKernel, dim3(int(((size_t)devEx.order.size + devi.Nblocks - 1) / devi.Nblocks)), dim3(devi.Nblocks), 0, 0,
+		devEx.order, devEx.h, devEx.bt, devi.w);
+	#else
+		hipLaunchKernelGGL(wKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.h, devi.b, devi.w);
+	#endif
+}
+
+void LBMTimeStep(mainDStruct devi, cudaStruct devEx, patchStruct* patches, int NP,
+	int t, int deltaTS, hipEvent_t ct1, hipEvent_t ct2, prec *msecs) {
+	float dt;
+
+	hipEventRecord(ct1);
+	PERF_BEGIN(PERF_PULL);
+	LBMpullLaunch(devi, devEx, t);
+	PERF_END(PERF_PULL);
+	PERF_BEGIN(PERF_REFINE);
+	patchTimeStep(devi, devEx, patches, NP, t);
+	PERF_END(PERF_REFINE);
+	#if LAZY
+		PERF_BEGIN(PERF_ACTIVITY);
+		hipLaunchKernelGGL(activityKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e,
+		devEx.activeTol, devi.node_types, devEx.h0, (t % 2 == 0) ? devEx.f2 : devEx.f1, devEx.active);
+		PERF_END(PERF_ACTIVITY);
+	#endif
 	hipEventRecord(ct2);
 	hipEventSynchronize(ct2);
 	hipEventElapsedTime(&dt, ct1, ct2);
 	*msecs += dt;
 
 	if (t%deltaTS == 0) {
-		hipLaunchKernelGGL(wKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.h, devi.b, devi.w);
+		PERF_BEGIN(PERF_SAMPLE);
+		wLaunch(devi, devEx);
 		hipLaunchKernelGGL(TSkernel, dim3(devi.NTS), dim3(1), 0, 0, devi.TSdata, devi.w, devi.TSind, t, deltaTS, devi.NTS, devi.TTS);
+		PERF_END(PERF_SAMPLE);
 	}
 }
 
-void setup(mainDStruct devi, cudaStruct devEx, int deltaTS) {
+#if OOC
+// Out-of-core steps (OOC=1): f1 and f2 are FIELD_FILE mappings and a pass
+// advances the grid by several steps strip by strip, LBM_OOC_ROWS rows per
+// strip (enough for 64 MB of populations by default). Strips are updated
+// as a wavefront: in round s strip s - k takes step t + k, k = 0, 1, ...,
+// once strip s - k + 1 has taken step t + k - 1, which is every ordering
+// the two buffers and the in-place h of the full-grid step need. Round s
+// prefetches strip s + 1, and writes back strip s - steps, which no later
+// update of the pass reads, while the strips in between are computed.
+typedef struct oocStruct {
+	int rows;
+	int strips;
+	int steps;
+} oocStruct;
+
+static oocStruct ooc = { 0, 0, 0 };
+
+static void oocInit(mainDStruct devi) {
+	if (ooc.rows > 0)
+		return;
+	const char* v = getenv("LBM_OOC_ROWS");
+	ooc.rows = (v != NULL) ? atoi(v) : (int)((64 << 20) / (18 * sizeof(pop) * (size_t)devi.Lx));
+	ooc.rows = std::max(1, std::min(ooc.rows, devi.Ly));
+	ooc.strips = (devi.Ly + ooc.rows - 1) / ooc.rows;
+	v = getenv("LBM_OOC_STEPS");
+	ooc.steps = std::max(1, (v != NULL) ? atoi(v) : 4);
+	std::cout << "Out-of-core: " << ooc.strips << " strips of " << ooc.rows << " rows, up to "
+			  << ooc.steps << " steps per pass" << std::endl;
+}
+
+// Prefetches or writes back rows [r0, r1) of every direction of f
+static void oocStrip(pop* f, mainDStruct devi, int r0, int r1, bool prefetch) {
+	size_t size = (size_t)devi.Lx * devi.Ly;
+	r0 = std::max(r0, 0);
+	r1 = std::min(r1, devi.Ly);
+	if (r0 >= r1)
+		return;
+	for (int k = 0; k < 9; k++) {
+		size_t offset = (k * size + (size_t)r0 * devi.Lx) * sizeof(pop);
+		size_t bytes = (size_t)(r1 - r0) * devi.Lx * sizeof(pop);
+		if (prefetch)
+			fieldPrefetch(f, offset, bytes);
+		else
+			fieldWriteBack(f, offset, bytes);
+	}
+}
+
+static void oocPass(mainDStruct devi, cudaStruct devEx, int t, int steps) {
+	int R = ooc.rows;
+	for (int s = 0; s < ooc.strips + steps - 1; s++) {
+		oocStrip(devEx.f1, devi, (s + 1) * R - 1, (s + 2) * R + 1, true);
+		oocStrip(devEx.f2, devi, (s + 1) * R - 1, (s + 2) * R + 1, true);
+		for (int k = 0; k < steps; k++) {
+			int strip = s - k;
+			if (strip < 0 || strip >= ooc.strips)
+				continue;
+			idx i0 = (idx)strip * R * devi.Lx;
+			idx i1 = (idx)std::min((strip + 1) * R, devi.Ly) * devi.Lx;
+			pop* fsrc = ((t + k) % 2 == 0) ? devEx.f1 : devEx.f2;
+			pop* fdst = ((t + k) % 2 == 0) ? devEx.f2 : devEx.f1;
+			hipLaunchKernelGGL(LBMpull, dim3(int((i1 - i0 + devi.Nblocks - 1) / devi.Nblocks)), dim3(devi.Nblocks), 0, 0,
+			devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.coll, devi.b, SLOPE_ARG, devEx.SC_bin, devEx.BB_bin, fsrc, fdst, devEx.h,
+			i0, i1);
+		}
+		int done = s - steps;
+		oocStrip(devEx.f1, devi, done * R, (done + 1) * R, false);
+		oocStrip(devEx.f2, devi, done * R, (done + 1) * R, false);
+	}
+}
+
+// Steps of the pass starting at t: up to LBM_OOC_STEPS, ending at tMax, at
+// the next step sampled for the time series or before the next output
+static int oocSteps(int t, int tMax, int deltaOutput, int deltaTS) {
+	int steps = std::min(ooc.steps, tMax - t + 1);
+	steps = std::min(steps, (t % deltaTS == 0) ? 1 : deltaTS - t % deltaTS + 1);
+	if (deltaOutput != 0)
+		steps = std::min(steps, deltaOutput - t % deltaOutput);
+	return steps;
+}
+
+static void oocTimeSteps(mainDStruct devi, cudaStruct devEx, int t, int steps, int deltaTS,
+	hipEvent_t ct1, hipEvent_t ct2, prec *msecs) {
+	float dt;
+
+	hipEventRecord(ct1);
+	PERF_BEGIN(PERF_PULL);
+	oocPass(devi, devEx, t, steps);
+	PERF_END(PERF_PULL);
+	hipEventRecord(ct2);
+	hipEventSynchronize(ct2);
+	hipEventElapsedTime(&dt, ct1, ct2);
+	*msecs += dt;
+
+	int last = t + steps - 1;
+	if (last%deltaTS == 0) {
+		PERF_BEGIN(PERF_SAMPLE);
+		wLaunch(devi, devEx);
+		hipLaunchKernelGGL(TSkernel, dim3(devi.NTS), dim3(1), 0, 0, devi.TSdata, devi.w, devi.TSind, last, deltaTS, devi.NTS, devi.TTS);
+		PERF_END(PERF_SAMPLE);
+	}
+}
+#endif
+
+void setupLevel(mainDStruct devi, cudaStruct devEx) {
+	#if SPARSE
+		// SC_bin, BB_bin and h were gathered into the tiles by sparseInit
+		hipLaunchKernelGGL(feqKernel, dim3(int(((size_t)devEx.Ntiles * TILE * TILE + devi.Nblocks - 1) / devi.Nblocks)), dim3(devi.Nblocks), 0, 0,
+		TILE * TILE, devEx.Ntiles, devEx.g, devEx.e, devEx.h, devEx.f1);
+	#elif ORDER
+		// Likewise gathered into the node ordering by orderedInit
+		hipLaunchKernelGGL(feqKernel, dim3(int(((size_t)devEx.order.size + devi.Nblocks - 1) / devi.Nblocks)), dim3(devi.Nblocks), 0, 0,
+		(int)devEx.order.size, 1, devEx.g, devEx.e, devEx.h, devEx.f1);
+	#else
 	#if IN == 3
-		hipLaunchKernelGGL(auxArraysKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.ex, devEx.ey, devi.node_types,
+		hipLaunchKernelGGL(auxArraysKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devi.node_types,
 		devEx.Arr_tri);
 	#elif IN == 4
-		hipLaunchKernelGGL(auxArraysKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.ex, devEx.ey, devi.node_types,
+		hipLaunchKernelGGL(auxArraysKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devi.node_types,
 		devEx.SC_bin, devEx.BB_bin);
+	#elif IN == 5
+		hipLaunchKernelGGL(auxArraysKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devi.node_types,
+		devEx.SCBB_bin);
+	#endif
+	#ifdef HIP_HOST
+		costInit(devi, devEx);
 	#endif
 	hipLaunchKernelGGL(hKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devi.w, devi.b, devEx.h);
+	#if SLOPE
+		hipLaunchKernelGGL(slopeKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devi.b, devEx.slope);
+	#endif
 
+	#if POP16
+		int NT9 = 9 * ((devi.Lx + TILE - 1) / TILE) * ((devi.Ly + TILE - 1) / TILE);
+		hipLaunchKernelGGL(popScaleInitKernel, dim3((NT9 + devi.Nblocks - 1) / devi.Nblocks), dim3(devi.Nblocks), 0, 0,
+		devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.h, devi.b, devEx.s1, devEx.wt);
+		hipMemcpy(devEx.s2, devEx.s1, NT9 * sizeof(float), hipMemcpyDeviceToDevice);
+		hipLaunchKernelGGL(feqKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.h, devEx.f1,
+		devi.b, devEx.s1, devEx.popFlags, devEx.wt);
+		hipMemset(devEx.popFlags, 0, 2 * NT9 * sizeof(unsigned char));
+	#else
 	hipLaunchKernelGGL(feqKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.h, devEx.f1);
+	#endif
+	#endif
+	#if LAZY
+		if (devEx.active != NULL) {
+			int Ntiles = ((devi.Lx + TILE - 1) / TILE) * ((devi.Ly + TILE - 1) / TILE);
+			hipLaunchKernelGGL(feqKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.g, devEx.e, devEx.h, devEx.f2);
+			hipMemcpy(devEx.h0, devEx.h, (size_t)devi.Lx*devi.Ly * sizeof(prec), hipMemcpyDeviceToDevice);
+			hipMemset(devEx.active, 0, Ntiles * sizeof(unsigned char));
+			hipLaunchKernelGGL(activeInitKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.activeTol,
+			devi.w, devi.node_types, devEx.active);
+		}
+	#endif
+}
+
+void setup(mainDStruct devi, cudaStruct devEx, patchStruct* patches, int NP, int deltaTS) {
+	setupLevel(devi, devEx);
+	for (int p = 0; p < NP; p++) {
+		setupLevel(patches[p].devi, patches[p].devEx);
+		#if LAZY
+			// Tiles under a patch receive restricted populations every step
+			int NTx = (devi.Lx + TILE - 1) / TILE;
+			int tx0 = patches[p].ox / TILE;
+			int tx1 = (patches[p].ox + (patches[p].devi.Lx - 1) / patches[p].ratio) / TILE;
+			int ty0 = patches[p].oy / TILE;
+			int ty1 = (patches[p].oy + (patches[p].devi.Ly - 1) / patches[p].ratio) / TILE;
+			for (int ty = ty0; ty <= ty1; ty++)
+				hipMemset(devEx.active + tx0 + ty * NTx, 1, (tx1 - tx0 + 1) * sizeof(unsigned char));
+		#endif
+	}
 
 	hipLaunchKernelGGL(TSkernel, dim3(devi.NTS), dim3(1), 0, 0, devi.TSdata, devi.w, devi.TSind, 0, deltaTS, devi.NTS, devi.TTS);
 }
 
 void copyAndWriteResultData(mainHStruct host, mainDStruct devi, cudaStruct devEx, int t, std::string outputdir) {
+	PERF_BEGIN(PERF_WRITE);
+	wLaunch(devi, devEx);
 
-	hipLaunchKernelGGL(wKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devEx.h, devi.b, devi.w);
+	hipMemcpy(host.w, devi.w, (size_t)devi.Lx*devi.Ly * sizeof(prec), hipMemcpyDeviceToHost);
 
-	hipMemcpy(host.w, devi.w, devi.Lx*devi.Ly * sizeof(prec), hipMemcpyDeviceToHost);
+	writeOutput((size_t)devi.Lx*devi.Ly, t, host.w, outputdir);
+	PERF_END(PERF_WRITE);
+}
 
-	writeOutput(devi.Lx*devi.Ly, t, host.w, outputdir);
+void copyAndWritePatchData(patchStruct* patches, int NP, int t) {
+	for (int p = 0; p < NP; p++)
+		copyAndWriteResultData(patches[p].host, patches[p].devi, patches[p].devEx, t, patches[p].outputdir);
 }
 
 void copyAndWriteTSData(mainHStruct host, mainDStruct devi, int deltaTS, prec Dt, std::string outputdir) {
 
-	hipMemcpy(host.TSdata, devi.TSdata, devi.TTS*devi.NTS * sizeof(prec), hipMemcpyDeviceToHost);
+	hipMemcpy(host.TSdata, devi.TSdata, (size_t)devi.TTS*devi.NTS * sizeof(prec), hipMemcpyDeviceToHost);
 
 	writeTS(devi.TTS, devi.NTS, deltaTS, Dt, host.TSdata, outputdir);
 }
 
-void LBM(mainHStruct host, mainDStruct devi, cudaStruct devEx, int* time_array, prec Dt, std::string outputdir) {
+void LBM(mainHStruct host, mainDStruct devi, cudaStruct devEx, patchStruct* patches, int NP,
+	int* time_array, prec Dt, std::string outputdir) {
 	hipFuncSetCacheConfig(reinterpret_cast<const void*>(reinterpret_cast<const void*>(LBMpull)), hipFuncCachePreferL1);
 	hipFuncSetCacheConfig(reinterpret_cast<const void*>(reinterpret_cast<const void*>(feqKernel)), hipFuncCachePreferL1);
 
@@ -888,19 +543,39 @@ void LBM(mainHStruct host, mainDStruct devi, cudaStruct devEx, int* time_array,
 	hipEventCreate(&ct1);
 	hipEventCreate(&ct2);
 	prec msecs = 0;
-	setup(devi, devEx, deltaTS);
+	PERF_BEGIN(PERF_SETUP);
+	setup(devi, devEx, patches, NP, deltaTS);
+	PERF_END(PERF_SETUP);
+	#ifdef HIP_HOST
+		hostBusyReset();
+	#endif
 	std::cout << std::fixed << std::setprecision(1);
+	#if OOC
+		oocInit(devi);
+	#endif
 	while (t <= tMax) {
-		LBMTimeStep(devi, devEx, t, deltaTS, ct1, ct2, &msecs);
+		#if OOC
+			int steps = oocSteps(t, tMax, deltaOutput, deltaTS);
+			oocTimeSteps(devi, devEx, t, steps, deltaTS, ct1, ct2, &msecs);
+			t += steps;
+		#else
+		LBMTimeStep(devi, devEx, patches, NP, t, deltaTS, ct1, ct2, &msecs);
 		t++;
+		#endif
 		if (deltaOutput != 0 && t%deltaOutput == 0) {
 			std::cout << "\rTime step: " << t << " (" << 100.0*t / tMax << "%)";
 			copyAndWriteResultData(host, devi, devEx, t, outputdir);
+			copyAndWritePatchData(patches, NP, t);
 		}
 	}
 	copyAndWriteResultData(host, devi, devEx, t, outputdir);
+	copyAndWritePatchData(patches, NP, t);
 	copyAndWriteTSData(host, devi, deltaTS, Dt, outputdir);
 	std::cout << std::endl << "Tiempo total: " << msecs << "[ms]" << std::endl;
 	std::cout << std::endl << "Tiempo promedio por iteracion: " << msecs / tMax << "[ms]" << std::endl;
+	PERF_REPORT((long long)devi.Lx * devi.Ly * (tMax + 1));
+	#ifdef HIP_HOST
+		hostBusyReport();
+	#endif
 }
 
@@ -0,0 +1,343 @@
+#include "hip/hip_runtime.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "include/alloc.cuh"
+
+#if !defined(_WIN32)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+// Every solver field is allocated here so its footprint is accounted for.
+// Host fields, and the device fields of the host backend (whose device
+// memory is host memory), are 64-byte aligned, or mapped page aligned when
+// they are FIELD_HUGE or at least FIELD_MAP_MIN bytes. Mapped fields follow
+// two environment variables:
+//   LBM_HUGEPAGES = thp | hugetlb        huge pages for FIELD_HUGE fields,
+//                                        transparent (madvise) or MAP_HUGETLB
+//   LBM_NUMA      = interleave | local   NUMA policy, set with mbind
+// A request the system refuses falls back to normal pages with a warning.
+// FIELD_FILE fields are shared mappings of a file created (and unlinked at
+// once) in LBM_OOC_DIR, the working directory by default, so the page
+// cache can write them back and evict them when RAM runs short.
+
+#define FIELD_ALIGN 64
+#define FIELD_MAP_MIN (1 << 20)
+#define HUGE_PAGE_BYTES (2 << 20)
+
+#ifndef MPOL_INTERLEAVE
+	#define MPOL_INTERLEAVE 3
+#endif
+#ifndef MPOL_LOCAL
+	#define MPOL_LOCAL 4
+#endif
+
+#define HUGE_OFF 0
+#define HUGE_THP 1
+#define HUGE_TLB 2
+#define NUMA_OFF 0
+#define NUMA_INTERLEAVE 1
+#define NUMA_LOCAL 2
+
+typedef struct fieldEntry {
+	std::string name;
+	size_t bytes;
+	bool device;
+	size_t mapped;
+	bool hip;
+	const char* pages;
+	int fd;
+} fieldEntry;
+
+static std::map<void*, fieldEntry> fields;
+static size_t current[2] = { 0, 0 }, peak[2] = { 0, 0 };
+static int hugeMode = -1, numaMode = NUMA_OFF;
+static bool numaWarned = false, tlbWarned = false;
+
+static void allocInit() {
+	if (hugeMode >= 0)
+		return;
+	hugeMode = HUGE_OFF;
+	const char* v = getenv("LBM_HUGEPAGES");
+	if (v != NULL && strcmp(v, "thp") == 0)
+		hugeMode = HUGE_THP;
+	else if (v != NULL && strcmp(v, "hugetlb") == 0)
+		hugeMode = HUGE_TLB;
+	else if (v != NULL && strcmp(v, "off") != 0)
+		std::cout << "Unknown LBM_HUGEPAGES value " << v << " ignored." << std::endl;
+	v = getenv("LBM_NUMA");
+	if (v != NULL && strcmp(v, "interleave") == 0)
+		numaMode = NUMA_INTERLEAVE;
+	else if (v != NULL && strcmp(v, "local") == 0)
+		numaMode = NUMA_LOCAL;
+	else if (v != NULL && strcmp(v, "off") != 0)
+		std::cout << "Unknown LBM_NUMA value " << v << " ignored." << std::endl;
+}
+
+#if !defined(_WIN32)
+// Online NUMA nodes from sysfs ("0-3,5"), as an mbind node mask
+static void onlineNodes(unsigned long* mask, int maxnode) {
+	int bits = 8 * sizeof(unsigned long);
+	char line[256] = "0";
+	FILE* fp = fopen("/sys/devices/system/node/online", "r");
+	if (fp != NULL) {
+		if (fgets(line, sizeof(line), fp) == NULL)
+			strcpy(line, "0");
+		fclose(fp);
+	}
+	memset(mask, 0, maxnode / 8);
+	char* s = line;
+	while (true) {
+		long first = strtol(s, &s, 10), last = first;
+		if (*s == '-')
+			last = strtol(s + 1, &s, 10);
+		for (long k = first; k <= last && k < maxnode; k++)
+			mask[k / bits] |= 1UL << (k % bits);
+		if (*s != ',')
+			break;
+		s++;
+	}
+}
+
+static void numaPolicy(void* p, size_t len) {
+	if (numaMode == NUMA_OFF)
+		return;
+	long err;
+	if (numaMode == NUMA_INTERLEAVE) {
+		unsigned long mask[16];
+		onlineNodes(mask, 8 * sizeof(mask));
+		err = syscall(SYS_mbind, p, len, MPOL_INTERLEAVE, mask, 8 * sizeof(mask), 0);
+	}
+	else
+		err = syscall(SYS_mbind, p, len, MPOL_LOCAL, NULL, 0, 0);
+	if (err != 0 && !numaWarned) {
+		std::cout << "Warning: mbind failed, fields keep the default NUMA policy." << std::endl;
+		numaWarned = true;
+	}
+}
+
+// Anonymous zeroed mapping; pages are only placed when first touched
+static void* mapField(size_t bytes, int flags, fieldEntry* e) {
+	size_t page = sysconf(_SC_PAGESIZE);
+	void* p = MAP_FAILED;
+	#ifdef MAP_HUGETLB
+		if ((flags & FIELD_HUGE) && hugeMode == HUGE_TLB) {
+			e->mapped = (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+			p = mmap(NULL, e->mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			e->pages = "hugetlb";
+			if (p == MAP_FAILED && !tlbWarned) {
+				std::cout << "Warning: MAP_HUGETLB failed (no huge pages reserved?), using transparent huge pages." << std::endl;
+				tlbWarned = true;
+			}
+		}
+	#endif
+	if (p == MAP_FAILED) {
+		e->mapped = (bytes + page - 1) / page * page;
+		p = mmap(NULL, e->mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p == MAP_FAILED)
+			return NULL;
+		e->pages = "4k";
+		#ifdef MADV_HUGEPAGE
+			if ((flags & FIELD_HUGE) && hugeMode != HUGE_OFF && madvise(p, e->mapped, MADV_HUGEPAGE) == 0)
+				e->pages = "thp";
+		#endif
+	}
+	numaPolicy(p, e->mapped);
+	return p;
+}
+
+// Zeroed (sparse) file of the field's size, mapped shared
+static void* fileField(size_t bytes, std::string name, fieldEntry* e) {
+	const char* dir = getenv("LBM_OOC_DIR");
+	std::string path = std::string(dir != NULL ? dir : ".") + "/lbm-" + name + "-XXXXXX";
+	std::vector<char> tmpl(path.begin(), path.end());
+	tmpl.push_back(0);
+	int fd = mkstemp(&tmpl[0]);
+	if (fd < 0) {
+		std::cout << "Can't create " << path << " for field " << name << "." << std::endl;
+		return NULL;
+	}
+	unlink(&tmpl[0]);
+	size_t page = sysconf(_SC_PAGESIZE);
+	e->mapped = (bytes + page - 1) / page * page;
+	void* p = MAP_FAILED;
+	if (ftruncate(fd, e->mapped) == 0)
+		p = mmap(NULL, e->mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (p == MAP_FAILED) {
+		close(fd);
+		return NULL;
+	}
+	e->fd = fd;
+	e->pages = "file";
+	return p;
+}
+#endif
+
+static void* hostMemory(size_t bytes, int flags, fieldEntry* e) {
+	allocInit();
+	e->mapped = 0;
+	e->hip = false;
+	e->pages = "-";
+	e->fd = -1;
+	#if defined(_WIN32)
+		void* p = _aligned_malloc(bytes ? bytes : 1, FIELD_ALIGN);
+	#else
+		if (flags & FIELD_FILE)
+			return fileField(bytes, e->name, e);
+		if ((flags & FIELD_HUGE) || bytes >= FIELD_MAP_MIN)
+			return mapField(bytes, flags, e);
+		void* p = NULL;
+		if (posix_memalign(&p, FIELD_ALIGN, bytes ? bytes : 1) != 0)
+			return NULL;
+	#endif
+	if (p != NULL)
+		memset(p, 0, bytes);
+	return p;
+}
+
+static void* record(void* p, fieldEntry e) {
+	if (p == NULL) {
+		std::cout << "Can't allocate " << e.bytes << " bytes for field " << e.name << "." << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	fields[p] = e;
+	current[e.device] += e.bytes;
+	if (current[e.device] > peak[e.device])
+		peak[e.device] = current[e.device];
+	return p;
+}
+
+void* hostFieldAlloc(std::string name, size_t bytes, int flags) {
+	fieldEntry e;
+	e.name = name;
+	e.bytes = bytes;
+	e.device = false;
+	void* p = hostMemory(bytes, flags, &e);
+	return record(p, e);
+}
+
+hipError_t fieldMalloc(void** ptr, size_t bytes, std::string name, int flags) {
+	fieldEntry e;
+	e.name = name;
+	e.bytes = bytes;
+	e.device = true;
+	#ifdef HIP_HOST
+		*ptr = hostMemory(bytes, flags, &e);
+	#else
+		e.mapped = 0;
+		e.hip = true;
+		e.pages = "-";
+		e.fd = -1;
+		if (hipMalloc(ptr, bytes) != hipSuccess)
+			*ptr = NULL;
+	#endif
+	record(*ptr, e);
+	return hipSuccess;
+}
+
+static void release(void* p) {
+	std::map<void*, fieldEntry>::iterator it = fields.find(p);
+	if (it == fields.end())
+		return;
+	fieldEntry& e = it->second;
+	current[e.device] -= e.bytes;
+	if (e.hip)
+		hipFree(p);
+	#if defined(_WIN32)
+		else
+			_aligned_free(p);
+	#else
+		else if (e.mapped != 0) {
+			munmap(p, e.mapped);
+			if (e.fd >= 0)
+				close(e.fd);
+		}
+		else
+			free(p);
+	#endif
+	fields.erase(it);
+}
+
+void hostFieldFree(void* p) {
+	release(p);
+}
+
+hipError_t fieldFree(void* p) {
+	release(p);
+	return hipSuccess;
+}
+
+// Page-aligned part of [offset, offset + bytes) of a FIELD_FILE field,
+// rounded outwards or inwards; false for other fields or an empty part
+static bool fileRange(void* p, size_t offset, size_t bytes, bool outwards, size_t* first, size_t* len, int* fd) {
+	#if defined(_WIN32)
+		return false;
+	#else
+		std::map<void*, fieldEntry>::iterator it = fields.find(p);
+		if (it == fields.end() || it->second.fd < 0)
+			return false;
+		size_t page = sysconf(_SC_PAGESIZE);
+		size_t end = std::min(offset + bytes, it->second.mapped);
+		size_t a = outwards ? offset / page * page : (offset + page - 1) / page * page;
+		size_t b = outwards ? (end + page - 1) / page * page : end / page * page;
+		b = std::min(b, it->second.mapped);
+		if (a >= b)
+			return false;
+		*first = a;
+		*len = b - a;
+		*fd = it->second.fd;
+		return true;
+	#endif
+}
+
+void fieldPrefetch(void* p, size_t offset, size_t bytes) {
+	size_t first, len;
+	int fd;
+	#if !defined(_WIN32)
+		if (fileRange(p, offset, bytes, true, &first, &len, &fd))
+			madvise((char*)p + first, len, MADV_WILLNEED);
+	#endif
+}
+
+// Dirty pages stay in the page cache after MADV_DONTNEED; the write-back
+// started here lets the kernel evict them without stalling a later fault.
+void fieldWriteBack(void* p, size_t offset, size_t bytes) {
+	size_t first, len;
+	int fd;
+	#if !defined(_WIN32)
+		if (fileRange(p, offset, bytes, false, &first, &len, &fd)) {
+			#ifdef SYNC_FILE_RANGE_WRITE
+				sync_file_range(fd, first, len, SYNC_FILE_RANGE_WRITE);
+			#endif
+			madvise((char*)p + first, len, MADV_DONTNEED);
+		}
+	#endif
+}
+
+// Live fields grouped by name and memory space, then current and peak totals
+void allocReport() {
+	std::map<std::string, std::pair<int, size_t> > rows;
+	std::map<std::string, std::string> pages;
+	for (std::map<void*, fieldEntry>::iterator it = fields.begin(); it != fields.end(); it++) {
+		std::string key = std::string(it->second.device ? "device " : "host   ") + it->second.name;
+		rows[key].first++;
+		rows[key].second += it->second.bytes;
+		if (pages[key].find(it->second.pages) == std::string::npos)
+			pages[key] += std::string(pages[key].empty() ? "" : ",") + it->second.pages;
+	}
+	std::cout << "Field memory:" << std::endl << std::fixed << std::setprecision(2);
+	for (std::map<std::string, std::pair<int, size_t> >::iterator it = rows.begin(); it != rows.end(); it++)
+		std::cout << "  " << std::left << std::setw(22) << it->first << std::right << std::setw(3) << it->second.first
+			<< " x" << std::setw(11) << it->second.second / 1048576.0 << " MB  pages " << pages[it->first] << std::endl;
+	std::cout << "  host   " << current[0] / 1048576.0 << " MB (peak " << peak[0] / 1048576.0 << " MB), device "
+		<< current[1] / 1048576.0 << " MB (peak " << peak[1] / 1048576.0 << " MB)" << std::endl;
+}
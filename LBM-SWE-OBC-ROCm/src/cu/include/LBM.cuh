@@ -4,6 +4,17 @@
 #include "../../include/structs.h"
 #include <string.h>
 
-void LBM(mainHStruct, mainDStruct, cudaStruct, int*, prec, std::string);
+#if POP16
+	__global__ void feqKernel(int, int, prec, prec, const prec* __restrict__, pop*,
+		const prec* __restrict__, const float* __restrict__, unsigned char*, const prec* __restrict__);
+#else
+	__global__ void feqKernel(int, int, prec, prec, const prec* __restrict__, pop*);
+#endif
+
+void setupLevel(mainDStruct, cudaStruct);
+
+void LBMpullLaunch(mainDStruct, cudaStruct, int);
+
+void LBM(mainHStruct, mainDStruct, cudaStruct, patchStruct*, int, int*, prec, std::string);
 
 #endif
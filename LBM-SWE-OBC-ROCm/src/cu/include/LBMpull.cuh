@@ -0,0 +1,546 @@
+#ifndef LBMPULL_CUH
+#define LBMPULL_CUH
+
+#include "../../include/structs.h"
+#include "setup.cuh"
+#include "pop16.cuh"
+#include "lattice.cuh"
+#include "collision.cuh"
+
+// Fused stream, boundary and collision step, one kernel per node
+// classification (IN): LBMpullDepth classifies from h > 0, LBMpullTypes from
+// node_types, LBMpullTri reads Arr_tri, LBMpullBin the SC/BB bitmasks and
+// LBMpullWord both bitmasks packed in one 16-bit word. Each turns its
+// classification into an SC/BB mask and runs pullMasked.
+// bn selects how the boundary treatment branches (BN): 1 if/else, 2 ternary
+// and 3 arithmetic blending. The solver instantiates the IN/BN pair it is
+// built with; bench-variants instantiates all fifteen. Bed slopes come from
+// the slopeKernel array when slope is not NULL, from b otherwise.
+// Populations are read and written through F1 and F2 (pop16.cuh) and
+// relaxed by collide (collision.cuh).
+// With SPLIT=1 LBMpullBulk updates the interior list and LBMpullWord only
+// the boundary list built by splitInit. With GHOST=1 LBMpullBin reads and
+// writes h, f1 and f2 at their ghost-framed storage index n. With OOC=1 it
+// updates the nodes [i0, i1) of one strip. With SPARSE=1 LBMpullSparse runs
+// the same update on the tiles of sparseInit, and with ORDER=1 or 2
+// LBMpullOrdered on the curve-ordered fields of orderedInit.
+
+// SC/BB mask loaders of pullMasked: SC in the low byte, BB in the high byte.
+// IN=2 uses typesMask (setup.cuh).
+struct binMask {
+	const unsigned char* __restrict__ SC_bin;
+	const unsigned char* __restrict__ BB_bin;
+	__device__ unsigned short operator()(idx i) const { return SC_bin[i] | BB_bin[i] << 8; }
+};
+
+struct wordMask {
+	const unsigned short* __restrict__ SCBB_bin;
+	__device__ unsigned short operator()(idx i) const { return SCBB_bin[i]; }
+};
+
+// IN=1: the node type follows from the depths, so a wet node is 2, or 1 when
+// a neighbour inside the domain is dry
+struct depthMask {
+	int Lx, Ly;
+	const prec* __restrict__ h;
+	__device__ int type(int x, int y) const {
+		return (x >= 0 && x < Lx && y >= 0 && y < Ly && h[(idx)y * Lx + x] > 0) ? 2 : 0;
+	}
+	__device__ unsigned short operator()(idx i) const {
+		if (!(h[i] > 0))
+			return 0;
+		int y = i / Lx;
+		int x = i - (idx)y * Lx;
+		int t = 2;
+		for (int a = 1; a < 9; a++) {
+			int xi = x - D2Q9::cx(a), yi = y - D2Q9::cy(a);
+			if (xi >= 0 && xi < Lx && yi >= 0 && yi < Ly && type(xi, yi) == 0)
+				t = 1;
+		}
+		return linkMask(*this, t, x, y, Lx, Ly, 2);
+	}
+};
+
+// IN=3: one byte per link in Arr_tri, 1 for SC and 2 for BB
+struct triMask {
+	idx size;
+	const unsigned char* __restrict__ Arr_tri;
+	__device__ unsigned short operator()(idx i) const {
+		unsigned short m = 0;
+		for (int j = 1; j < 9; j++) {
+			unsigned char t = Arr_tri[i + j * size];
+			m |= (t == 1) << (j - 1) | (t == 2) << (j + 7);
+		}
+		return m;
+	}
+};
+
+// Node addressing of pullMasked. count() is the number of nodes and
+// links(i, nb, db) returns the storage index of node i, with nb[k] the one
+// of the node population k streams from (-1 outside the stored domain, which
+// never happens when guarded is false) and db[k] the bed step of link k.
+struct denseNodes {
+	static constexpr bool guarded = !GHOST;
+	int Lx, Ly;
+	const prec* __restrict__ b;
+	const sprec* __restrict__ slope;
+	__device__ idx count() const { return (idx)Lx * Ly; }
+	__device__ idx links(idx i, idx* nb, prec* db) const {
+		int y = i / Lx;
+		int x = i - (idx)y * Lx;
+		bedSlopes(db, i, x, y, Lx, Ly, count(), b, slope);
+		#if GHOST
+			idx n = ghostIndex(i, Lx);
+			int P = ghostPitch(Lx);
+			nb[1] = n     - 1;
+			nb[2] = n - P    ;
+			nb[3] = n     + 1;
+			nb[4] = n + P    ;
+			nb[5] = n - P - 1;
+			nb[6] = n - P + 1;
+			nb[7] = n + P + 1;
+			nb[8] = n + P - 1;
+			return n;
+		#else
+			nb[1] = (             x != 0   ) ? i      - 1 : -1;
+			nb[2] = (y != 0                ) ? i - Lx     : -1;
+			nb[3] = (             x != Lx-1) ? i      + 1 : -1;
+			nb[4] = (y != Ly-1             ) ? i + Lx     : -1;
+			nb[5] = (y != 0    && x != 0   ) ? i - Lx - 1 : -1;
+			nb[6] = (y != 0    && x != Lx-1) ? i - Lx + 1 : -1;
+			nb[7] = (y != Ly-1 && x != Lx-1) ? i + Lx + 1 : -1;
+			nb[8] = (y != Ly-1 && x != 0   ) ? i + Lx - 1 : -1;
+			return i;
+		#endif
+	}
+};
+
+#if SPARSE
+// Storage index of the node at local coordinates (lx, ly) of tile slot, where
+// lx and ly may step one node outside the tile. Returns -1 for tiles that were
+// never allocated (land or outside the domain).
+__device__ inline idx sparseNeighbour(int slot, int lx, int ly, const int* __restrict__ tileNbr) {
+	int cx = (lx < 0) ? 0 : ((lx < TILE) ? 1 : 2);
+	int cy = (ly < 0) ? 0 : ((ly < TILE) ? 1 : 2);
+	int nslot = tileNbr[9 * slot + cx + 3 * cy];
+	if (nslot < 0)
+		return -1;
+	return (idx)nslot * TILE * TILE + (lx + TILE) % TILE + ((ly + TILE) % TILE) * TILE;
+}
+
+struct sparseNodes {
+	static constexpr bool guarded = true;
+	int Ntiles;
+	const int* __restrict__ tileNbr;
+	const prec* __restrict__ b;
+	__device__ idx count() const { return (idx)Ntiles * TILE * TILE; }
+	__device__ idx links(idx i, idx* nb, prec* db) const {
+		int slot = i / (TILE * TILE);
+		int l = i - (idx)slot * TILE * TILE;
+		int ly = l / TILE;
+		int lx = l - ly * TILE;
+		nb[1] = sparseNeighbour(slot, lx - 1, ly    , tileNbr);
+		nb[2] = sparseNeighbour(slot, lx    , ly - 1, tileNbr);
+		nb[3] = sparseNeighbour(slot, lx + 1, ly    , tileNbr);
+		nb[4] = sparseNeighbour(slot, lx    , ly + 1, tileNbr);
+		nb[5] = sparseNeighbour(slot, lx - 1, ly - 1, tileNbr);
+		nb[6] = sparseNeighbour(slot, lx + 1, ly - 1, tileNbr);
+		nb[7] = sparseNeighbour(slot, lx + 1, ly + 1, tileNbr);
+		nb[8] = sparseNeighbour(slot, lx - 1, ly + 1, tileNbr);
+		for (int k = 1; k < 9; k++)
+			db[k] = b[i] - ((nb[k] >= 0) ? b[nb[k]] : 0);
+		return i;
+	}
+};
+#endif
+
+// Fields stored in the node ordering o (ordering.h): ORDER=1 or 2 in the
+// solver, and every ordering in bench-ordering. Padding nodes of partial
+// tiles carry no mask, so links only sees nodes inside the domain.
+struct orderedNodes {
+	static constexpr bool guarded = true;
+	orderStruct o;
+	const prec* __restrict__ b;
+	__device__ idx count() const { return o.size; }
+	__device__ idx links(idx i, idx* nb, prec* db) const {
+		int x, y;
+		orderCoords(o, i, &x, &y);
+		for (int k = 1; k < 9; k++) {
+			int dx = -D2Q9::cx(k), dy = -D2Q9::cy(k);
+			bool in = x + dx >= 0 && x + dx < o.Lx && y + dy >= 0 && y + dy < o.Ly;
+			nb[k] = in ? orderNeighbour(o, i, x, y, dx, dy) : -1;
+			db[k] = b[i] - (in ? b[nb[k]] : 0);
+		}
+		return i;
+	}
+};
+
+// Update of node i shared by all the pull kernels, which differ in how the
+// masks are stored or derived (Mask) and in how nodes are addressed (Nodes).
+template <int bn, class Nodes, class Mask>
+__device__ inline void pullMasked(idx i, const Nodes& nodes, Mask mask, prec g, prec e, const collStruct& coll,
+	const pop* __restrict__ f1, pop* f2, prec* h
+	#if POP16
+	, const float* __restrict__ s1, const float* __restrict__ s2, unsigned char* popFlags,
+	const prec* __restrict__ wt
+	#endif
+	) {
+	#if POP16
+		const prec* __restrict__ b = nodes.b;
+	#endif
+	#if GHOST || POP16
+		// Both store dense fields only (structs.h)
+		int Lx = nodes.Lx, Ly = nodes.Ly;
+	#endif
+	idx size = nodes.count();
+	int j;
+	prec ftemp[9], feq[9];
+	prec uxlocal, uylocal;
+	prec hlocal[9], db[9];
+	prec gh, usq, ux3, uy3, uxuy5, uxuy6;
+	prec fact1 = 1 / (9 * e*e);
+	prec fact2 = fact1 * 0.25;
+	prec factS = fact1 * 1.5;
+	if (i < size) {
+		unsigned short SCBB = mask(i);
+		unsigned char SC = SCBB & 255;
+		unsigned char BB = SCBB >> 8;
+		if(SCBB != 0){
+			idx nb[9];
+			idx n = nodes.links(i, nb, db);
+			POP16_NODE(n);
+			hlocal[0] = h[n];
+			for (j = 1; j < 9; j++) {
+				bool in = !Nodes::guarded || nb[j] >= 0;
+				hlocal[j] = in ? h[nb[j]] : 0;
+				ftemp[j] = in ? F1(nb[j], j) : 0;
+			}
+
+			ftemp[0] = FN(n, 0); 
+			if (bn == 1) {
+				if((SC>>0) & 1) ftemp[1] = ftemp[1] - g * (hlocal[0] + hlocal[1]) * db[1] * factS; else ftemp[1] = FN(n, 1);
+				if((SC>>1) & 1) ftemp[2] = ftemp[2] - g * (hlocal[0] + hlocal[2]) * db[2] * factS; else ftemp[2] = FN(n, 2);
+				if((SC>>2) & 1) ftemp[3] = ftemp[3] - g * (hlocal[0] + hlocal[3]) * db[3] * factS; else ftemp[3] = FN(n, 3);
+				if((SC>>3) & 1) ftemp[4] = ftemp[4] - g * (hlocal[0] + hlocal[4]) * db[4] * factS; else ftemp[4] = FN(n, 4);
+				if((SC>>4) & 1) ftemp[5] = ftemp[5] - g * (hlocal[0] + hlocal[5]) * db[5] * factS * 0.25; else ftemp[5] = FN(n, 5);
+				if((SC>>5) & 1) ftemp[6] = ftemp[6] - g * (hlocal[0] + hlocal[6]) * db[6] * factS * 0.25; else ftemp[6] = FN(n, 6);
+				if((SC>>6) & 1) ftemp[7] = ftemp[7] - g * (hlocal[0] + hlocal[7]) * db[7] * factS * 0.25; else ftemp[7] = FN(n, 7);
+				if((SC>>7) & 1) ftemp[8] = ftemp[8] - g * (hlocal[0] + hlocal[8]) * db[8] * factS * 0.25; else ftemp[8] = FN(n, 8);
+
+				if((BB>>(0)) & 1) ftemp[1] = ftemp[3];
+				if((BB>>(1)) & 1) ftemp[2] = ftemp[4];
+				if((BB>>(2)) & 1) ftemp[3] = ftemp[1];
+				if((BB>>(3)) & 1) ftemp[4] = ftemp[2];
+				if((BB>>(4)) & 1) ftemp[5] = ftemp[7];
+				if((BB>>(5)) & 1) ftemp[6] = ftemp[8];
+				if((BB>>(6)) & 1) ftemp[7] = ftemp[5];
+				if((BB>>(7)) & 1) ftemp[8] = ftemp[6];
+			}
+			else if (bn == 2) {
+				ftemp[1] = ((SC>>0) & 1) ? (ftemp[1] - g * (hlocal[0] + hlocal[1]) * db[1] * factS) : FN(n, 1);
+				ftemp[2] = ((SC>>1) & 1) ? (ftemp[2] - g * (hlocal[0] + hlocal[2]) * db[2] * factS) : FN(n, 2);
+				ftemp[3] = ((SC>>2) & 1) ? (ftemp[3] - g * (hlocal[0] + hlocal[3]) * db[3] * factS) : FN(n, 3);
+				ftemp[4] = ((SC>>3) & 1) ? (ftemp[4] - g * (hlocal[0] + hlocal[4]) * db[4] * factS) : FN(n, 4);
+				ftemp[5] = ((SC>>4) & 1) ? (ftemp[5] - g * (hlocal[0] + hlocal[5]) * db[5] * factS * 0.25) : FN(n, 5);
+				ftemp[6] = ((SC>>5) & 1) ? (ftemp[6] - g * (hlocal[0] + hlocal[6]) * db[6] * factS * 0.25) : FN(n, 6);
+				ftemp[7] = ((SC>>6) & 1) ? (ftemp[7] - g * (hlocal[0] + hlocal[7]) * db[7] * factS * 0.25) : FN(n, 7);
+				ftemp[8] = ((SC>>7) & 1) ? (ftemp[8] - g * (hlocal[0] + hlocal[8]) * db[8] * factS * 0.25) : FN(n, 8);
+
+				ftemp[1] = ((BB>>(0)) & 1) ? ftemp[3] : ftemp[1];
+				ftemp[2] = ((BB>>(1)) & 1) ? ftemp[4] : ftemp[2];
+				ftemp[3] = ((BB>>(2)) & 1) ? ftemp[1] : ftemp[3];
+				ftemp[4] = ((BB>>(3)) & 1) ? ftemp[2] : ftemp[4];
+				ftemp[5] = ((BB>>(4)) & 1) ? ftemp[7] : ftemp[5];
+				ftemp[6] = ((BB>>(5)) & 1) ? ftemp[8] : ftemp[6];
+				ftemp[7] = ((BB>>(6)) & 1) ? ftemp[5] : ftemp[7];
+				ftemp[8] = ((BB>>(7)) & 1) ? ftemp[6] : ftemp[8]; 
+			}
+			else {
+				ftemp[1] = ((SC>>0) & 1) * (ftemp[1] - g * (hlocal[0] + hlocal[1]) * db[1] * factS       ) + !((SC>>0) & 1) * FN(n, 1);
+				ftemp[2] = ((SC>>1) & 1) * (ftemp[2] - g * (hlocal[0] + hlocal[2]) * db[2] * factS       ) + !((SC>>1) & 1) * FN(n, 2);
+				ftemp[3] = ((SC>>2) & 1) * (ftemp[3] - g * (hlocal[0] + hlocal[3]) * db[3] * factS       ) + !((SC>>2) & 1) * FN(n, 3);
+				ftemp[4] = ((SC>>3) & 1) * (ftemp[4] - g * (hlocal[0] + hlocal[4]) * db[4] * factS       ) + !((SC>>3) & 1) * FN(n, 4);
+				ftemp[5] = ((SC>>4) & 1) * (ftemp[5] - g * (hlocal[0] + hlocal[5]) * db[5] * factS * 0.25) + !((SC>>4) & 1) * FN(n, 5);
+				ftemp[6] = ((SC>>5) & 1) * (ftemp[6] - g * (hlocal[0] + hlocal[6]) * db[6] * factS * 0.25) + !((SC>>5) & 1) * FN(n, 6);
+				ftemp[7] = ((SC>>6) & 1) * (ftemp[7] - g * (hlocal[0] + hlocal[7]) * db[7] * factS * 0.25) + !((SC>>6) & 1) * FN(n, 7);
+				ftemp[8] = ((SC>>7) & 1) * (ftemp[8] - g * (hlocal[0] + hlocal[8]) * db[8] * factS * 0.25) + !((SC>>7) & 1) * FN(n, 8);
+
+				ftemp[1] += ((BB>>(0)) & 1) * (ftemp[3] - ftemp[1]);
+				ftemp[2] += ((BB>>(1)) & 1) * (ftemp[4] - ftemp[2]);
+				ftemp[3] += ((BB>>(2)) & 1) * (ftemp[1] - ftemp[3]);
+				ftemp[4] += ((BB>>(3)) & 1) * (ftemp[2] - ftemp[4]); 
+				ftemp[5] += ((BB>>(4)) & 1) * (ftemp[7] - ftemp[5]);
+				ftemp[6] += ((BB>>(5)) & 1) * (ftemp[8] - ftemp[6]);
+				ftemp[7] += ((BB>>(6)) & 1) * (ftemp[5] - ftemp[7]);
+				ftemp[8] += ((BB>>(7)) & 1) * (ftemp[6] - ftemp[8]);
+			}
+
+			hlocal[0] = ftemp[0] + (ftemp[1] + ftemp[2] + ftemp[3] + ftemp[4]) + (ftemp[5] + ftemp[6] + ftemp[7] + ftemp[8]);
+			uxlocal = e * ((ftemp[1] - ftemp[3]) + (ftemp[5] - ftemp[6] - ftemp[7] + ftemp[8])) / hlocal[0];
+			uylocal = e * ((ftemp[2] - ftemp[4]) + (ftemp[5] + ftemp[6] - ftemp[7] - ftemp[8])) / hlocal[0];
+
+			h[n] = hlocal[0];
+
+			gh = 1.5 * g * hlocal[0];
+			usq = 1.5 * (uxlocal * uxlocal + uylocal * uylocal);
+			ux3 = 3.0 * e * uxlocal;
+			uy3 = 3.0 * e * uylocal;
+			uxuy5 = ux3 + uy3;
+			uxuy6 = uy3 - ux3;
+
+			feq[0] = hlocal[0] - fact1 * hlocal[0] * (5.0 * gh + 4.0 * usq);
+			feq[1] = fact1 * hlocal[0] * (gh + ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
+			feq[2] = fact1 * hlocal[0] * (gh + uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
+			feq[3] = fact1 * hlocal[0] * (gh - ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
+			feq[4] = fact1 * hlocal[0] * (gh - uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
+			feq[5] = fact2 * hlocal[0] * (gh + uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
+			feq[6] = fact2 * hlocal[0] * (gh + uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
+			feq[7] = fact2 * hlocal[0] * (gh - uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
+			feq[8] = fact2 * hlocal[0] * (gh - uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
+			collide(ftemp, feq, coll);
+			for (j = 0; j < 9; j++)
+				F2(n, j, ftemp[j]);
+		}
+	} 
+}
+
+
+template <int bn>
+__global__ void LBMpullDepth(int Lx, int Ly, prec g, prec e, collStruct coll,
+	const prec* __restrict__ b, const sprec* __restrict__ slope,
+	const pop* __restrict__ f1, pop* f2, prec* h
+	#if LAZY
+	, const unsigned char* __restrict__ active
+	#endif
+	#if POP16
+	, const float* __restrict__ s1, const float* __restrict__ s2, unsigned char* popFlags,
+	const prec* __restrict__ wt
+	#endif
+	) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	#if LAZY
+		if (active != NULL && i < (idx)Lx * Ly && !active[tileIndex(i, Lx)]) return;
+	#endif
+	denseNodes nodes = {Lx, Ly, b, slope};
+	depthMask mask = {Lx, Ly, h};
+	pullMasked<bn>(i, nodes, mask, g, e, coll, f1, f2, h
+	#if POP16
+	, s1, s2, popFlags, wt
+	#endif
+	);
+}
+
+template <int bn>
+__global__ void LBMpullTypes(int Lx, int Ly, prec g, prec e, collStruct coll,
+	const prec* __restrict__ b, const sprec* __restrict__ slope, const int* __restrict__ node_types,
+	const pop* __restrict__ f1, pop* f2, prec* h
+	#if LAZY
+	, const unsigned char* __restrict__ active
+	#endif
+	#if POP16
+	, const float* __restrict__ s1, const float* __restrict__ s2, unsigned char* popFlags,
+	const prec* __restrict__ wt
+	#endif
+	) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	#if LAZY
+		if (active != NULL && i < (idx)Lx * Ly && !active[tileIndex(i, Lx)]) return;
+	#endif
+	denseNodes nodes = {Lx, Ly, b, slope};
+	typesMask mask = {Lx, Ly, node_types};
+	pullMasked<bn>(i, nodes, mask, g, e, coll, f1, f2, h
+	#if POP16
+	, s1, s2, popFlags, wt
+	#endif
+	);
+}
+
+template <int bn>
+__global__ void LBMpullTri(int Lx, int Ly, prec g, prec e, collStruct coll,
+	const prec* __restrict__ b, const sprec* __restrict__ slope, const unsigned char* __restrict__ Arr_tri,
+	const pop* __restrict__ f1, pop* f2, prec* h
+	#if LAZY
+	, const unsigned char* __restrict__ active
+	#endif
+	#if POP16
+	, const float* __restrict__ s1, const float* __restrict__ s2, unsigned char* popFlags,
+	const prec* __restrict__ wt
+	#endif
+	) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	#if LAZY
+		if (active != NULL && i < (idx)Lx * Ly && !active[tileIndex(i, Lx)]) return;
+	#endif
+	denseNodes nodes = {Lx, Ly, b, slope};
+	triMask mask = {(idx)Lx * Ly, Arr_tri};
+	pullMasked<bn>(i, nodes, mask, g, e, coll, f1, f2, h
+	#if POP16
+	, s1, s2, popFlags, wt
+	#endif
+	);
+}
+
+template <int bn>
+__global__ void LBMpullBin(int Lx, int Ly, prec g, prec e, collStruct coll,
+	const prec* __restrict__ b, const sprec* __restrict__ slope, const unsigned char* __restrict__ SC_bin, 
+	const unsigned char* __restrict__ BB_bin, const pop* __restrict__ f1, 
+	pop* f2, prec* h
+	#if LAZY
+	, const unsigned char* __restrict__ active
+	#endif
+	#if POP16
+	, const float* __restrict__ s1, const float* __restrict__ s2, unsigned char* popFlags,
+	const prec* __restrict__ wt
+	#endif
+	#if OOC
+	, idx i0, idx i1
+	#endif
+	) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	#if OOC
+		i += i0;
+		if (i >= i1) return;
+	#endif
+	#if LAZY
+		if (active != NULL && i < (idx)Lx * Ly && !active[tileIndex(i, Lx)]) return;
+	#endif
+	denseNodes nodes = {Lx, Ly, b, slope};
+	binMask mask = {SC_bin, BB_bin};
+	pullMasked<bn>(i, nodes, mask, g, e, coll, f1, f2, h
+	#if POP16
+	, s1, s2, popFlags, wt
+	#endif
+	);
+}
+
+template <int bn>
+__global__ void LBMpullWord(int Lx, int Ly, prec g, prec e, collStruct coll,
+	const prec* __restrict__ b, const sprec* __restrict__ slope, const unsigned short* __restrict__ SCBB_bin,
+	const pop* __restrict__ f1, 
+	pop* f2, prec* h
+	#if LAZY
+	, const unsigned char* __restrict__ active
+	#endif
+	#if POP16
+	, const float* __restrict__ s1, const float* __restrict__ s2, unsigned char* popFlags,
+	const prec* __restrict__ wt
+	#endif
+	#if SPLIT
+	, const idx* __restrict__ bnd, idx Nbnd
+	#endif
+	) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	#if LAZY
+		if (active != NULL && i < (idx)Lx * Ly && !active[tileIndex(i, Lx)]) return;
+	#endif
+	#if SPLIT
+		if (i >= Nbnd) return;
+		i = bnd[i];
+	#endif
+	denseNodes nodes = {Lx, Ly, b, slope};
+	wordMask mask = {SCBB_bin};
+	pullMasked<bn>(i, nodes, mask, g, e, coll, f1, f2, h
+	#if POP16
+	, s1, s2, popFlags, wt
+	#endif
+	);
+}
+
+#if SPARSE
+// IN=4 update of the block-sparse tiles of sparseInit
+template <int bn>
+__global__ void LBMpullSparse(int Ntiles, prec g, prec e, collStruct coll,
+	const int* __restrict__ tileNbr, const prec* __restrict__ b,
+	const unsigned char* __restrict__ SC_bin, const unsigned char* __restrict__ BB_bin,
+	const prec* __restrict__ f1, prec* f2, prec* h) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	sparseNodes nodes = {Ntiles, tileNbr, b};
+	binMask mask = {SC_bin, BB_bin};
+	pullMasked<bn>(i, nodes, mask, g, e, coll, f1, f2, h);
+}
+#endif
+
+// IN=4 update of fields stored in the node ordering o
+template <int bn>
+__global__ void LBMpullOrdered(orderStruct o, prec g, prec e, collStruct coll, const prec* __restrict__ b,
+	const unsigned char* __restrict__ SC_bin, const unsigned char* __restrict__ BB_bin,
+	const prec* __restrict__ f1, prec* f2, prec* h) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	orderedNodes nodes = {o, b};
+	binMask mask = {SC_bin, BB_bin};
+	pullMasked<bn>(i, nodes, mask, g, e, coll, f1, f2, h);
+}
+
+#if SPLIT
+// Interior nodes of the split: all eight links stream with the bed slope
+// correction and every neighbour is inside the domain, so there are no
+// masks to load and no edge tests. Same arithmetic as LBMpullWord; the slope
+// source is fixed at compile time by SLOPE.
+__global__ void LBMpullBulk(int Lx, int Ly, idx Nbulk, prec g, prec e, collStruct coll,
+	const prec* __restrict__ b,
+	#if SLOPE
+	const sprec* __restrict__ slope,
+	#endif
+	const idx* __restrict__ bulk, const pop* __restrict__ f1, pop* f2, prec* h
+	#if POP16
+	, const float* __restrict__ s1, const float* __restrict__ s2, unsigned char* popFlags,
+	const prec* __restrict__ wt
+	#endif
+	) {
+	idx t = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	idx size = (idx)Lx * Ly;
+	int j, k;
+	prec ftemp[9], feq[9];
+	prec uxlocal, uylocal;
+	prec hlocal[9], db[9];
+	prec gh, usq, ux3, uy3, uxuy5, uxuy6;
+	prec fact1 = 1 / (9 * e*e);
+	prec fact2 = fact1 * 0.25;
+	prec factS = fact1 * 1.5;
+	if (t < Nbulk) {
+		idx i = bulk[t];
+		POP16_NODE(i);
+		hlocal[0] = h[i];
+		ftemp[0] = FN(i, 0);
+		for (k = 1; k < 9; k++) {
+			idx n = IDX<D2Q9>(i, k, Lx);
+			hlocal[k] = h[n];
+			#if SLOPE
+				db[k] = (prec)slope[i + (k - 1) * size];
+			#else
+				db[k] = b[i] - b[n];
+			#endif
+			prec corr = g * (hlocal[0] + hlocal[k]) * db[k] * factS;
+			ftemp[k] = F1(n, k) - ((k < 5) ? corr : corr * 0.25);
+		}
+
+		hlocal[0] = ftemp[0] + (ftemp[1] + ftemp[2] + ftemp[3] + ftemp[4]) + (ftemp[5] + ftemp[6] + ftemp[7] + ftemp[8]);
+		uxlocal = e * ((ftemp[1] - ftemp[3]) + (ftemp[5] - ftemp[6] - ftemp[7] + ftemp[8])) / hlocal[0];
+		uylocal = e * ((ftemp[2] - ftemp[4]) + (ftemp[5] + ftemp[6] - ftemp[7] - ftemp[8])) / hlocal[0];
+
+		h[i] = hlocal[0];
+
+		gh = 1.5 * g * hlocal[0];
+		usq = 1.5 * (uxlocal * uxlocal + uylocal * uylocal);
+		ux3 = 3.0 * e * uxlocal;
+		uy3 = 3.0 * e * uylocal;
+		uxuy5 = ux3 + uy3;
+		uxuy6 = uy3 - ux3;
+
+		feq[0] = hlocal[0] - fact1 * hlocal[0] * (5.0 * gh + 4.0 * usq);
+		feq[1] = fact1 * hlocal[0] * (gh + ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
+		feq[2] = fact1 * hlocal[0] * (gh + uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
+		feq[3] = fact1 * hlocal[0] * (gh - ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
+		feq[4] = fact1 * hlocal[0] * (gh - uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
+		feq[5] = fact2 * hlocal[0] * (gh + uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
+		feq[6] = fact2 * hlocal[0] * (gh + uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
+		feq[7] = fact2 * hlocal[0] * (gh - uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
+		feq[8] = fact2 * hlocal[0] * (gh - uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
+		collide(ftemp, feq, coll);
+		for (j = 0; j < 9; j++)
+			F2(i, j, ftemp[j]);
+	}
+}
+#endif
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef ALLOC_CUH
+#define ALLOC_CUH
+
+#include "hip/hip_runtime.h"
+#include <stddef.h>
+#include <string>
+
+// Population arrays: eligible for huge pages (LBM_HUGEPAGES)
+#define FIELD_HUGE 1
+// Out-of-core arrays: mapped from a file in LBM_OOC_DIR (host memory only)
+#define FIELD_FILE 2
+
+void* hostFieldAlloc(std::string, size_t, int = 0);
+
+void hostFieldFree(void*);
+
+hipError_t fieldMalloc(void**, size_t, std::string, int = 0);
+
+hipError_t fieldFree(void*);
+
+// Starts reading bytes [offset, offset + bytes) of a FIELD_FILE field ahead
+// of use, or writing them back and dropping them from the process; no-ops
+// for other fields.
+void fieldPrefetch(void*, size_t, size_t);
+
+void fieldWriteBack(void*, size_t, size_t);
+
+void allocReport();
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef COLLISION_CUH
+#define COLLISION_CUH
+
+#include "hip/hip_runtime.h"
+#include "../../include/structs.h"
+
+// Relaxes the streamed populations f towards feq in place with the
+// operator chosen in the configuration. BGK keeps the single rate 1/tau.
+// TRT relaxes the even part of each link pair with tau and the odd part
+// with tauMinus. MRT relaxes the non-equilibrium moments of the D2Q9
+// basis of Lallemand and Luo: energy, energy squared and heat flux with
+// sE, sEps and sQ, the stresses (and the conserved moments, whose
+// non-equilibrium part is zero) with 1/tau.
+__device__ inline void collide(prec* f, const prec* feq, const collStruct& c) {
+	int j;
+	if (c.model == COLL_TRT) {
+		// the link pairs (1,3) (2,4) (5,7) (6,8)
+		const int pair[4] = {1, 2, 5, 6};
+		prec wp = 1 / c.tau, wm = 1 / c.tauMinus;
+		f[0] = f[0] - (f[0] - feq[0]) * wp;
+		for (int p = 0; p < 4; p++) {
+			j = pair[p];
+			int o = j + 2;
+			prec dj = f[j] - feq[j], dop = f[o] - feq[o];
+			prec dp = 0.5 * (dj + dop), dm = 0.5 * (dj - dop);
+			f[j] = f[j] - wp * dp - wm * dm;
+			f[o] = f[o] - wp * dp + wm * dm;
+		}
+	}
+	else if (c.model == COLL_MRT) {
+		prec d[9];
+		for (j = 0; j < 9; j++)
+			d[j] = f[j] - feq[j];
+		prec ws = 1 / c.tau;
+		prec dax = (d[1] + d[2] + d[3] + d[4]), ddg = (d[5] + d[6] + d[7] + d[8]);
+		// non-equilibrium moments times their rate over the squared norm
+		prec me = c.sE * (-4 * d[0] - dax + 2 * ddg) / 36;
+		prec meps = c.sEps * (4 * d[0] - 2 * dax + ddg) / 36;
+		prec mqx = c.sQ * (-2 * (d[1] - d[3]) + (d[5] - d[6] - d[7] + d[8])) / 12;
+		prec mqy = c.sQ * (-2 * (d[2] - d[4]) + (d[5] + d[6] - d[7] - d[8])) / 12;
+		prec mxx = ws * ((d[1] - d[2] + d[3] - d[4])) / 4;
+		prec mxy = ws * ((d[5] - d[6] + d[7] - d[8])) / 4;
+		prec mh = ws * (d[0] + dax + ddg) / 9;
+		prec mjx = ws * ((d[1] - d[3]) + (d[5] - d[6] - d[7] + d[8])) / 6;
+		prec mjy = ws * ((d[2] - d[4]) + (d[5] + d[6] - d[7] - d[8])) / 6;
+		f[0] -= mh - 4 * me + 4 * meps;
+		f[1] -= mh - me - 2 * meps + mjx - 2 * mqx + mxx;
+		f[2] -= mh - me - 2 * meps + mjy - 2 * mqy - mxx;
+		f[3] -= mh - me - 2 * meps - mjx + 2 * mqx + mxx;
+		f[4] -= mh - me - 2 * meps - mjy + 2 * mqy - mxx;
+		f[5] -= mh + 2 * me + meps + mjx + mqx + mjy + mqy + mxy;
+		f[6] -= mh + 2 * me + meps - mjx - mqx + mjy + mqy - mxy;
+		f[7] -= mh + 2 * me + meps - mjx - mqx - mjy - mqy + mxy;
+		f[8] -= mh + 2 * me + meps + mjx + mqx - mjy - mqy - mxy;
+	}
+	else {
+		for (j = 0; j < 9; j++)
+			f[j] = f[j] - (f[j] - feq[j]) / c.tau;
+	}
+}
+
+#endif
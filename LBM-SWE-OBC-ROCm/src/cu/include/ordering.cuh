@@ -0,0 +1,30 @@
+#ifndef ORDERING_CUH
+#define ORDERING_CUH
+
+#include "hip/hip_runtime.h"
+#include "../../include/structs.h"
+
+// Copies a dense field into the node ordering o; padding nodes are zeroed.
+template <typename T>
+__global__ void orderGatherKernel(orderStruct o, const T* __restrict__ dense, T* ordered) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < o.size) {
+		int x, y;
+		orderCoords(o, i, &x, &y);
+		ordered[i] = (x < o.Lx && y < o.Ly) ? dense[x + (idx)y * o.Lx] : 0;
+	}
+}
+
+__global__ void orderWKernel(orderStruct, const prec* __restrict__, const prec* __restrict__, prec*);
+
+orderStruct orderUpload(const orderStruct&);
+
+void orderRelease(orderStruct);
+
+#if ORDER
+	void orderedInit(mainHStruct, mainDStruct, cudaStruct*);
+
+	void orderedFree(cudaStruct);
+#endif
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef POP16_CUH
+#define POP16_CUH
+
+#include "hip/hip_runtime.h"
+#include "../../include/structs.h"
+#include "setup.cuh"
+#include <math.h>
+
+// 16-bit population storage (POP16=1). Each population is kept as its
+// deviation from the rest state of feqKernel at the still-water depth
+// wt - b, wt being the mean surface of the tile's wet nodes at setup, in
+// units of a power-of-two scale per tile and direction; all arithmetic
+// stays in prec. The writer of a population raises two flags of its tile
+// and direction: keep when the value uses the upper bits of the range,
+// grow (with the missing power of two) when it would not fit in 14 bits.
+// popScaleKernel then sets the scale of the next write to the other
+// buffer. Writers may race on grow with different shifts; any of them
+// still grows the scale and values clamp at +-32767 in the meantime.
+#if POP16
+	#define POP16_KEEP 8192
+	#define POP16_GROW 16384
+	#define POP16_MINEXP -100
+
+	// Population k of feqKernel for the depth d
+	__host__ __device__ inline prec restPop(int k, prec d, prec g, prec e) {
+		prec gh1 = g * d * d / (6.0 * e * e);
+		if (k == 0)
+			return d - 5.0 * gh1;
+		return (k < 5) ? gh1 : gh1 / 4;
+	}
+
+	// Reads population k of node n with the rest state of n. The pull kernels
+	// use it for the neighbours only; a node's own populations go through its
+	// popNode.
+	__device__ inline prec loadPop(const pop* __restrict__ f, const float* __restrict__ s,
+		const prec* __restrict__ wt, idx n, int k, idx size, int Lx, prec bn, prec g, prec e) {
+		int t = tileIndex(n, Lx);
+		return restPop(k, wt[t] - bn, g, e) + (prec)s[t * 9 + k] * f[n + k * size];
+	}
+
+	// Rest populations of one node (k = 0, axes, diagonals) with its tile and
+	// the scales of both buffers, loaded once in the prologue of a kernel
+	typedef struct popNode {
+		int t;
+		prec rest[3];
+		float s1[9], s2[9];
+	} popNode;
+
+	__device__ inline popNode popNodeInit(idx n, int Lx, prec bn, const prec* __restrict__ wt,
+		const float* __restrict__ s1, const float* __restrict__ s2, prec g, prec e) {
+		popNode p;
+		p.t = tileIndex(n, Lx);
+		prec d = wt[p.t] - bn;
+		p.rest[0] = restPop(0, d, g, e);
+		p.rest[1] = restPop(1, d, g, e);
+		p.rest[2] = restPop(5, d, g, e);
+		for (int k = 0; k < 9; k++) {
+			p.s1[k] = s1[p.t * 9 + k];
+			p.s2[k] = s2[p.t * 9 + k];
+		}
+		return p;
+	}
+
+	__device__ inline prec popRest(const popNode& p, int k) {
+		return p.rest[(k == 0) ? 0 : ((k < 5) ? 1 : 2)];
+	}
+
+	__device__ inline prec loadNodePop(const pop* __restrict__ f, const popNode& p, idx n, int k, idx size) {
+		return popRest(p, k) + (prec)p.s1[k] * f[n + k * size];
+	}
+
+	__device__ inline void storeNodePop(pop* f, unsigned char* flags, const popNode& p, idx n, int k, idx size, prec v) {
+		prec r = (v - popRest(p, k)) / p.s2[k];
+		prec a = fabs(r);
+		if (a >= POP16_KEEP) {
+			int tk = p.t * 9 + k;
+			flags[2 * tk] = 1;
+			if (a >= POP16_GROW) {
+				int shift = ilogb(a) - 13;
+				flags[2 * tk + 1] = (unsigned char)(shift < 64 ? shift : 64);
+			}
+		}
+		f[n + k * size] = (pop)rint(fmax(fmin(r, (prec)32767), (prec)-32767));
+	}
+#endif
+
+// Population k of node n as read from f1 and written to f2 by the pull
+// kernels; FN reads the updated node itself, whose POP16 rest state and
+// scales POP16_NODE loads once in the kernel prologue
+#if POP16
+	#define POP16_NODE(n) popNode pn = popNodeInit((n), Lx, b[(n)], wt, s1, s2, g, e)
+	#define F1(n, k) loadPop(f1, s1, wt, (n), (k), size, Lx, b[(n)], g, e)
+	#define FN(n, k) loadNodePop(f1, pn, (n), (k), size)
+	#define F2(n, k, v) storeNodePop(f2, popFlags, pn, (n), (k), size, (v))
+#elif GHOST
+	// n is the storage index (ghostIndex)
+	#define POP16_NODE(n)
+	#define F1(n, k) f1[(n) + (k) * ghostSize(Lx, Ly)]
+	#define FN(n, k) F1(n, k)
+	#define F2(n, k, v) f2[(n) + (k) * ghostSize(Lx, Ly)] = (v)
+#else
+	#define POP16_NODE(n)
+	#define F1(n, k) f1[(n) + (k) * size]
+	#define FN(n, k) F1(n, k)
+	#define F2(n, k, v) f2[(n) + (k) * size] = (v)
+#endif
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef REFINE_CUH
+#define REFINE_CUH
+
+#include "../../include/structs.h"
+
+__global__ void coarseToFineKernel(int, int, int, int, int, int, int, prec, prec, prec, prec,
+	const int* __restrict__, const int* __restrict__, const prec* __restrict__,
+	const prec* __restrict__, prec*, prec*);
+
+__global__ void fineToCoarseKernel(int, int, int, int, int, int, int, prec, prec, prec,
+	const int* __restrict__, const int* __restrict__, const prec* __restrict__,
+	prec*, prec*);
+
+#endif
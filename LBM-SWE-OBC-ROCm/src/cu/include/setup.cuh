@@ -2,12 +2,172 @@
 #define SETUP_CUH
 
 #include "../../include/structs.h"
+#include "lattice.cuh"
 
 #if IN == 3
-	__global__ void auxArraysKernel(int, int, const int* __restrict__, const int* __restrict__, const int* __restrict__, unsigned char*);
+	__global__ void auxArraysKernel(int, int, const int* __restrict__, unsigned char*);
 #elif IN == 4
-	__global__ void auxArraysKernel(int, int, const int* __restrict__, const int* __restrict__, const int* __restrict__, unsigned char*, unsigned char*);
+	__global__ void auxArraysKernel(int, int, const int* __restrict__, unsigned char*, unsigned char*);
+#elif IN == 5
+	__global__ void auxArraysKernel(int, int, const int* __restrict__, unsigned short*);
 #endif
+void uploadTypes(int*, const unsigned char*, int, int, int);
 __global__ void hKernel(int, int, const prec* __restrict__, const prec* __restrict__, prec*);
+__global__ void slopeKernel(int, int, const prec* __restrict__, sprec*);
+#ifdef HIP_HOST
+	// Relative pull cost of a dry, an interior and a boundary node
+	#define COST_DRY 1
+	#define COST_WET 8
+	#define COST_BND 12
+	void costInit(mainDStruct, cudaStruct);
+#endif
+#if SPLIT
+	void splitInit(mainDStruct, cudaStruct*);
+	void splitFree(cudaStruct);
+#endif
+
+// Ghost frame (GHOST=1): h, f1 and f2 are stored with one cell of zeros
+// around the grid and a row pitch padded so that every row starts on a
+// 64-byte line. The frame holds what the bounds guards of the pull kernels
+// give outside the domain, and no kernel writes it, so LBMpullBin reads
+// the neighbours of any node unconditionally. ghostIndex maps node i to
+// its storage index and ghostSize is the size of one field; both are the
+// plain node index and count with GHOST=0.
+#define GHOST_PAD (64 / (int)sizeof(prec))
+
+__host__ __device__ inline int ghostPitch(int Lx) {
+	return GHOST_PAD + (Lx + GHOST_PAD) / GHOST_PAD * GHOST_PAD;
+}
+
+__host__ __device__ inline idx ghostSize(int Lx, int Ly) {
+	#if GHOST
+		return (idx)ghostPitch(Lx) * (Ly + 2);
+	#else
+		return (idx)Lx * Ly;
+	#endif
+}
+
+__host__ __device__ inline idx ghostIndex(idx i, int Lx) {
+	#if GHOST
+		int y = i / Lx;
+		int x = i - (idx)y * Lx;
+		return (idx)(y + 1) * ghostPitch(Lx) + GHOST_PAD + x;
+	#else
+		return i;
+	#endif
+}
+
+// Bed step b[i] - b[i - e_k] of each link k = 1..8, with b = 0 outside the
+// domain: read from the array of slopeKernel if there is one, otherwise
+// gathered from the eight neighbours in b.
+__device__ inline void bedSlopes(prec* db, idx i, int x, int y, int Lx, int Ly, idx size,
+	const prec* __restrict__ b, const sprec* __restrict__ slope) {
+	int k;
+	if (slope != NULL) {
+		for (k = 1; k < 9; k++)
+			db[k] = slope[i + (k - 1) * size];
+		return;
+	}
+	prec blocal[9];
+	blocal[0] = b[i];
+	blocal[1] = (             x != 0   ) ? b[i      - 1] : 0;
+	blocal[2] = (y != 0                ) ? b[i - Lx    ] : 0;
+	blocal[3] = (             x != Lx-1) ? b[i      + 1] : 0;
+	blocal[4] = (y != Ly-1             ) ? b[i + Lx    ] : 0;
+	blocal[5] = (y != 0    && x != 0   ) ? b[i - Lx - 1] : 0;
+	blocal[6] = (y != 0    && x != Lx-1) ? b[i - Lx + 1] : 0;
+	blocal[7] = (y != Ly-1 && x != Lx-1) ? b[i + Lx + 1] : 0;
+	blocal[8] = (y != Ly-1 && x != 0   ) ? b[i + Lx - 1] : 0;
+	for (k = 1; k < 9; k++)
+		db[k] = blocal[0] - blocal[k];
+}
+// Boundary classification of link k = 1..8 of the node at (x, y) of type t
+// (0 dry, 1 next to a dry node, 2 wet inside): bit k-1 of the low byte if
+// the population streams with the slope correction (SC), of the high byte
+// if it bounces back (BB). types.type(xi, yi) is the type of a neighbour; a
+// diagonal link from a neighbour of type coast also bounces back when one of
+// the two nodes beside it is dry. Shared by auxArraysKernel and the pull
+// kernels that classify on the fly.
+template <class Types>
+__device__ inline unsigned short linkMask(const Types& types, int t, int x, int y, int Lx, int Ly, int coast) {
+	int xi, yi, a;
+	int valueSC = 0, valueBB = 0;
+	if (t == 2) {
+		if (y == 0) {
+			if (x == 0) 
+				valueSC += 4 + 8 + 64;
+			else if (x == Lx - 1)
+				valueSC += 1 + 8 + 128;
+			else 
+				valueSC += 1 + 4 + 8 + 64 + 128;
+		}
+		else if (y == Ly - 1) {
+			if (x == 0) 
+				valueSC += 2 + 4 + 32;
+			else if (x == Lx - 1) 
+				valueSC += 1 + 2 + 16;
+			else 
+				valueSC += 1 + 2 + 4 + 16 + 32;
+		}
+		else {
+			if (x == 0)
+				valueSC += 2 + 4 + 8 + 32 + 64;
+			else if (x == Lx - 1) 
+				valueSC += 1 + 2 + 8 + 16 + 128;
+			else  
+				valueSC = 255;
+		}
+	}
+	else if (t == 1) {
+		if (y == 0) {
+			valueSC += 1 + 8 + 128;
+			valueBB += 4 + 32 + 64;
+		}
+		else if (y == Ly - 1) {
+			valueSC += 1 + 2 + 16;
+			valueBB += 4 + 32 + 64;
+		}
+		else {
+			for (a = 1; a<9; a++) {
+				yi = y - D2Q9::cy(a);
+				xi = x - D2Q9::cx(a);
+				int ti = types.type(xi, yi);
+				if (ti != 0) 
+					valueSC += (1 << (a-1));
+				else 
+					valueBB += (1 << (a-1));
+				if (a > 4 && ti == coast) {
+					if (types.type(xi, y) == 0 || types.type(x, yi) == 0) {
+						valueSC -= (1 << (a-1));
+						valueBB += (1 << (a-1));
+					}
+				}
+			}
+		}
+	}
+	return (unsigned short)(valueSC | (valueBB << 8));
+}
+
+// node_types as the Types of linkMask (IN=2 and auxArraysKernel)
+struct typesMask {
+	int Lx, Ly;
+	const int* __restrict__ node_types;
+	__device__ int type(int x, int y) const { return node_types[(idx)y * Lx + x]; }
+	__device__ unsigned short operator()(idx i) const {
+		int y = i / Lx;
+		int x = i - (idx)y * Lx;
+		return linkMask(*this, node_types[i], x, y, Lx, Ly, 1);
+	}
+};
+
+#if LAZY
+	__global__ void activeInitKernel(int, int, prec, const prec* __restrict__, const int* __restrict__, unsigned char*);
+#endif
+#if LAZY || POP16
+	__device__ inline int tileIndex(idx i, int Lx) {
+		int y = i / Lx;
+		return int(i - (idx)y * Lx) / TILE + (y / TILE) * ((Lx + TILE - 1) / TILE);
+	}
+#endif
 
 #endif
@@ -0,0 +1,15 @@
+#ifndef SPARSE_CUH
+#define SPARSE_CUH
+
+#include "../../include/structs.h"
+
+#if SPARSE
+	__global__ void sparseWKernel(int, int, int, const int* __restrict__, const prec* __restrict__,
+		const prec* __restrict__, prec*);
+
+	void sparseInit(mainHStruct, mainDStruct, cudaStruct*);
+
+	void sparseFree(cudaStruct);
+#endif
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef TUNE_CUH
+#define TUNE_CUH
+
+#include "../../include/structs.h"
+#include <string>
+
+void tuneLaunch(mainDStruct*, cudaStruct, const unsigned char*, bool, std::string);
+
+#endif
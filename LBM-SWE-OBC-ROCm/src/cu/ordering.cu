@@ -0,0 +1,89 @@
+#include "hip/hip_runtime.h"
+#include <iostream>
+#include "include/ordering.cuh"
+#include "include/setup.cuh"
+#include "include/alloc.cuh"
+#include "../include/structs.h"
+
+__global__ void orderWKernel(orderStruct o, const prec* __restrict__ h, const prec* __restrict__ b, prec* w) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < o.size) {
+		int x, y;
+		orderCoords(o, i, &x, &y);
+		if (x < o.Lx && y < o.Ly)
+			w[x + (idx)y * o.Lx] = h[i] + b[i];
+	}
+}
+
+// Device copy of an orderInit ordering, the tile tables moved to the device
+orderStruct orderUpload(const orderStruct& o) {
+	orderStruct d = o;
+	if (o.type != ORDER_ROW) {
+		int NT = o.NTx * o.NTy;
+		fieldMalloc((void**)&d.tileSlot, NT * sizeof(int), "tileSlot");
+		fieldMalloc((void**)&d.tileXY, 2 * NT * sizeof(int), "tileXY");
+		hipMemcpy(d.tileSlot, o.tileSlot, NT * sizeof(int), hipMemcpyHostToDevice);
+		hipMemcpy(d.tileXY, o.tileXY, 2 * NT * sizeof(int), hipMemcpyHostToDevice);
+	}
+	return d;
+}
+
+void orderRelease(orderStruct d) {
+	fieldFree(d.tileSlot);
+	fieldFree(d.tileXY);
+}
+
+#if ORDER
+// Stores b, h, SC_bin, BB_bin and the populations in the node ordering ORDER;
+// only w stays dense.
+void orderedInit(mainHStruct host, mainDStruct devi, cudaStruct* devEx) {
+	int Lx = devi.Lx, Ly = devi.Ly;
+	orderStruct o;
+	orderInit(&o, ORDER, Lx, Ly);
+	devEx->order = orderUpload(o);
+	orderFree(&o);
+
+	size_t num_bytes_o = (size_t)o.size * sizeof(prec);
+	size_t num_bytes_c = (size_t)o.size * sizeof(unsigned char);
+	fieldMalloc((void**)&devEx->bt, num_bytes_o, "bt");
+	fieldMalloc((void**)&devEx->h, num_bytes_o, "h");
+	fieldMalloc((void**)&devEx->f1, 9 * num_bytes_o, "f1", FIELD_HUGE);
+	fieldMalloc((void**)&devEx->f2, 9 * num_bytes_o, "f2", FIELD_HUGE);
+	fieldMalloc((void**)&devEx->SC_bin, num_bytes_c, "SC_bin");
+	fieldMalloc((void**)&devEx->BB_bin, num_bytes_c, "BB_bin");
+
+	// Dense temporaries, released once the ordered fields are filled
+	prec *bd, *hd;
+	int* typesd;
+	unsigned char *SCd, *BBd;
+	fieldMalloc((void**)&bd, (size_t)Lx * Ly * sizeof(prec), "bd");
+	fieldMalloc((void**)&hd, (size_t)Lx * Ly * sizeof(prec), "hd");
+	fieldMalloc((void**)&typesd, (size_t)Lx * Ly * sizeof(int), "typesd");
+	fieldMalloc((void**)&SCd, (size_t)Lx * Ly * sizeof(unsigned char), "SCd");
+	fieldMalloc((void**)&BBd, (size_t)Lx * Ly * sizeof(unsigned char), "BBd");
+	hipMemcpy(bd, host.b, (size_t)Lx * Ly * sizeof(prec), hipMemcpyHostToDevice);
+	uploadTypes(typesd, host.node_types, Lx, Ly, devi.Nblocks);
+	hipLaunchKernelGGL(auxArraysKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, Lx, Ly, typesd,
+	SCd, BBd);
+	hipLaunchKernelGGL(hKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, Lx, Ly, devi.w, bd, hd);
+
+	int Ogrid = int(((size_t)o.size + devi.Nblocks - 1) / devi.Nblocks);
+	hipLaunchKernelGGL(orderGatherKernel<prec>, dim3(Ogrid), dim3(devi.Nblocks), 0, 0, devEx->order, bd, devEx->bt);
+	hipLaunchKernelGGL(orderGatherKernel<prec>, dim3(Ogrid), dim3(devi.Nblocks), 0, 0, devEx->order, hd, devEx->h);
+	hipLaunchKernelGGL(orderGatherKernel<unsigned char>, dim3(Ogrid), dim3(devi.Nblocks), 0, 0, devEx->order, SCd, devEx->SC_bin);
+	hipLaunchKernelGGL(orderGatherKernel<unsigned char>, dim3(Ogrid), dim3(devi.Nblocks), 0, 0, devEx->order, BBd, devEx->BB_bin);
+	fieldFree(bd);
+	fieldFree(hd);
+	fieldFree(typesd);
+	fieldFree(SCd);
+	fieldFree(BBd);
+
+	std::cout << "Node ordering: " << orderName(ORDER) << " over " << TILE << "x" << TILE << " tiles, "
+		<< o.size << " nodes stored for " << (size_t)Lx * Ly << "." << std::endl;
+}
+
+void orderedFree(cudaStruct devEx) {
+	orderRelease(devEx.order);
+	fieldFree(devEx.bt);
+}
+#endif
@@ -0,0 +1,128 @@
+#include "hip/hip_runtime.h"
+#include "include/refine.cuh"
+#include "../include/structs.h"
+
+__device__ void feqSWE(prec* feq, prec hlocal, prec uxlocal, prec uylocal,
+	prec g, prec e) {
+	prec fact1 = 1 / (9 * e*e);
+	prec fact2 = fact1 * 0.25;
+	prec gh = 1.5 * g * hlocal;
+	prec usq = 1.5 * (uxlocal * uxlocal + uylocal * uylocal);
+	prec ux3 = 3.0 * e * uxlocal;
+	prec uy3 = 3.0 * e * uylocal;
+	prec uxuy5 = ux3 + uy3;
+	prec uxuy6 = uy3 - ux3;
+
+	feq[0] = hlocal - fact1 * hlocal * (5.0 * gh + 4.0 * usq);
+	feq[1] = fact1 * hlocal * (gh + ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
+	feq[2] = fact1 * hlocal * (gh + uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
+	feq[3] = fact1 * hlocal * (gh - ux3 + 0.5 * ux3*ux3 * 9 * fact1 - usq);
+	feq[4] = fact1 * hlocal * (gh - uy3 + 0.5 * uy3*uy3 * 9 * fact1 - usq);
+	feq[5] = fact2 * hlocal * (gh + uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
+	feq[6] = fact2 * hlocal * (gh + uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
+	feq[7] = fact2 * hlocal * (gh - uxuy5 + 0.5 * uxuy5*uxuy5 * 9 * fact1 - usq);
+	feq[8] = fact2 * hlocal * (gh - uxuy6 + 0.5 * uxuy6*uxuy6 * 9 * fact1 - usq);
+}
+
+// Rescales post-collision populations between levels keeping h and hu:
+// f = feq + alpha * (f - feq)
+__device__ prec rescale(prec* f, prec alpha, prec g, prec e) {
+	prec feq[9];
+	prec hlocal = f[0] + (f[1] + f[2] + f[3] + f[4]) + (f[5] + f[6] + f[7] + f[8]);
+	prec uxlocal = e * ((f[1] - f[3]) + (f[5] - f[6] - f[7] + f[8])) / hlocal;
+	prec uylocal = e * ((f[2] - f[4]) + (f[5] + f[6] - f[7] - f[8])) / hlocal;
+	feqSWE(feq, hlocal, uxlocal, uylocal, g, e);
+	for (int j = 0; j < 9; j++)
+		f[j] = feq[j] + alpha * (f[j] - feq[j]);
+	return hlocal;
+}
+
+// One thread per node of the outer ring of the patch. The ring is filled with
+// coarse populations interpolated bilinearly in space and linearly in time
+// (frac = 0 at the start of the coarse step, frac = 1 at its end).
+__global__ void coarseToFineKernel(int Lx, int Ly, int LxF, int LyF,
+	int ratio, int ox, int oy, prec alpha, prec frac, prec g, prec e,
+	const int* __restrict__ node_types, const int* __restrict__ node_typesF,
+	const prec* __restrict__ fOld, const prec* __restrict__ fNew,
+	prec* fF, prec* hF) {
+
+	int r = threadIdx.x + blockIdx.x*blockDim.x;
+	idx size = (idx)Lx * Ly, sizeF = (idx)LxF * LyF;
+	if (r < 2 * LxF + 2 * (LyF - 2)) {
+		int xf, yf;
+		if (r < LxF) {
+			xf = r;
+			yf = 0;
+		}
+		else if (r < 2 * LxF) {
+			xf = r - LxF;
+			yf = LyF - 1;
+		}
+		else if (r < 2 * LxF + LyF - 2) {
+			xf = 0;
+			yf = r - 2 * LxF + 1;
+		}
+		else {
+			xf = LxF - 1;
+			yf = r - 2 * LxF - LyF + 3;
+		}
+		idx iF = xf + (idx)yf * LxF;
+		if (node_typesF[iF] == 0)
+			return;
+
+		int xc = ox + xf / ratio;
+		int yc = oy + yf / ratio;
+		prec rx = (prec)(xf % ratio) / ratio;
+		prec ry = (prec)(yf % ratio) / ratio;
+		int xn = (xc < Lx - 1) ? xc + 1 : xc;
+		int yn = (yc < Ly - 1) ? yc + 1 : yc;
+		idx ind[4] = { xc + (idx)yc * Lx, xn + (idx)yc * Lx, xc + (idx)yn * Lx, xn + (idx)yn * Lx };
+		prec wgt[4] = { (1 - rx) * (1 - ry), rx * (1 - ry), (1 - rx) * ry, rx * ry };
+		prec wsum = 0, flocal[9];
+		int a, j;
+		for (a = 0; a < 4; a++) {
+			if (node_types[ind[a]] == 0)
+				wgt[a] = 0;
+			wsum += wgt[a];
+		}
+		if (wsum == 0)
+			return;
+		for (j = 0; j < 9; j++) {
+			flocal[j] = 0;
+			for (a = 0; a < 4; a++)
+				flocal[j] += wgt[a] * ((1 - frac) * fOld[ind[a] + j * size] + frac * fNew[ind[a] + j * size]);
+			flocal[j] /= wsum;
+		}
+		hF[iF] = rescale(flocal, alpha, g, e);
+		for (j = 0; j < 9; j++)
+			fF[iF + j * sizeF] = flocal[j];
+	}
+}
+
+// One thread per coarse node strictly inside the patch. Coarse nodes on the
+// patch edge keep their own dynamics and drive the fine ring.
+__global__ void fineToCoarseKernel(int Lx, int Ly, int LxF, int LyF,
+	int ratio, int ox, int oy, prec alpha, prec g, prec e,
+	const int* __restrict__ node_types, const int* __restrict__ node_typesF,
+	const prec* __restrict__ fF, prec* f, prec* h) {
+
+	int i = threadIdx.x + blockIdx.x*blockDim.x;
+	int LxC = (LxF - 1) / ratio - 1;
+	int LyC = (LyF - 1) / ratio - 1;
+	idx size = (idx)Lx * Ly, sizeF = (idx)LxF * LyF;
+	if (i < LxC * LyC) {
+		int y = i / LxC;
+		int x = i - y * LxC;
+		idx iC = (ox + x + 1) + (idx)(oy + y + 1) * Lx;
+		idx iF = (x + 1) * ratio + (idx)(y + 1) * ratio * LxF;
+		if (node_types[iC] == 0 || node_typesF[iF] == 0)
+			return;
+		prec flocal[9];
+		int j;
+		for (j = 0; j < 9; j++)
+			flocal[j] = fF[iF + j * sizeF];
+		h[iC] = rescale(flocal, alpha, g, e);
+		for (j = 0; j < 9; j++)
+			f[iC + j * size] = flocal[j];
+	}
+}
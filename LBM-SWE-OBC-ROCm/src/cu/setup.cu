@@ -1,87 +1,175 @@
 #include "hip/hip_runtime.h"
 #include <iostream>
 #include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "include/setup.cuh"
+#include "include/alloc.cuh"
 #include "../include/structs.h"
 
 __global__ void auxArraysKernel(int Lx, int Ly,
-	const int* __restrict__ ex, const int* __restrict__ ey,
 	const int* __restrict__ node_types,
-	unsigned char* SC_bin, unsigned char* BB_bin) {
+	#if IN == 3
+	unsigned char* Arr_tri
+	#elif IN == 5
+	unsigned short* SCBB_bin
+	#else
+	unsigned char* SC_bin, unsigned char* BB_bin
+	#endif
+	) {
 
-	int i = threadIdx.x + blockIdx.x*blockDim.x;
-	int size = Lx * Ly;
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	idx size = (idx)Lx * Ly;
 	if (i < size) {
-		int y = (int)i / Lx;
-		int x = i - y * Lx;
-		int xi, yi, ind, indj, indk, a;
-		int valueSC = 0, valueBB = 0;
-		if (node_types[i] == 2) {
-			if (y == 0) {
-				if (x == 0) 
-					valueSC += 4 + 8 + 64;
-				else if (x == Lx - 1)
-					valueSC += 1 + 8 + 128;
-				else 
-					valueSC += 1 + 4 + 8 + 64 + 128;
-			}
-			else if (y == Ly - 1) {
-				if (x == 0) 
-					valueSC += 2 + 4 + 32;
-				else if (x == Lx - 1) 
-					valueSC += 1 + 2 + 16;
-				else 
-					valueSC += 1 + 2 + 4 + 16 + 32;
-			}
-			else {
-				if (x == 0)
-					valueSC += 2 + 4 + 8 + 32 + 64;
-				else if (x == Lx - 1) 
-					valueSC += 1 + 2 + 8 + 16 + 128;
-				else  
-					valueSC = 255;
-			}
-		}
-		else if (node_types[i] == 1) {
-			if (y == 0) {
-				valueSC += 1 + 8 + 128;
-				valueBB += 4 + 32 + 64;
-			}
-			else if (y == Ly - 1) {
-				valueSC += 1 + 2 + 16;
-				valueBB += 4 + 32 + 64;
-			}
-			else {
-				for (a = 1; a<9; a++) {
-					yi = y - ey[a];
-					xi = x - ex[a];
-					ind = yi * Lx + xi;
-					if (node_types[ind] != 0) 
-						valueSC += (1 << (a-1));
-					else 
-						valueBB += (1 << (a-1));
-					if (a > 4) {
-						if (node_types[ind] == 1) {
-							indj = y * Lx + xi;
-							indk = yi * Lx + x;
-							if (node_types[indj] == 0 || node_types[indk] == 0) {
-								valueSC -= (1 << (a-1));
-								valueBB += (1 << (a-1));
-							}
-						}
-					}
-				}
-			}
-		}
-		SC_bin[i] = (unsigned char) valueSC;
-		BB_bin[i] = (unsigned char) valueBB;
+		typesMask types = {Lx, Ly, node_types};
+		unsigned short mask = types(i);
+		#if IN == 3
+			// One byte per direction: 1 streams, 2 bounces back, 0 is dry
+			for (int a = 1; a < 9; a++)
+				Arr_tri[i + a * size] = ((mask >> (a-1)) & 1) + 2 * ((mask >> (a+7)) & 1);
+		#elif IN == 5
+			SCBB_bin[i] = mask;
+		#else
+			SC_bin[i] = (unsigned char) (mask & 255);
+			BB_bin[i] = (unsigned char) (mask >> 8);
+		#endif
 	}
 } 
 
+__global__ void typesKernel(int Lx, int Ly, const unsigned char* __restrict__ types,
+	int* node_types) {
+
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)Lx*Ly) {
+		node_types[i] = (types[i / 4] >> (2 * (i % 4))) & 3;
+	}
+}
+
+// Sends the packed host node types and widens them on the device
+void uploadTypes(int* node_types, const unsigned char* types, int Lx, int Ly, int Nblocks) {
+	size_t bytes = TYPES_BYTES((size_t)Lx * Ly);
+	unsigned char* packed;
+	fieldMalloc((void**)&packed, bytes, "types");
+	hipMemcpy(packed, types, bytes, hipMemcpyHostToDevice);
+	int grid = int(((size_t)Lx * Ly + Nblocks - 1) / Nblocks);
+	hipLaunchKernelGGL(typesKernel, dim3(grid), dim3(Nblocks), 0, 0, Lx, Ly, packed, node_types);
+	fieldFree(packed);
+}
+
 __global__ void hKernel(int Lx, int Ly, const prec* __restrict__ w,
 	const prec* __restrict__ b, prec* h) {
 
-	int i = threadIdx.x + blockIdx.x*blockDim.x;
-	if (i < Lx*Ly) {
-		h[i] = w[i] - b[i];
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)Lx*Ly) {
+		h[ghostIndex(i, Lx)] = w[i] - b[i];
+	}
+}
+
+// The bed never changes, so the slope of every link is stored once
+__global__ void slopeKernel(int Lx, int Ly, const prec* __restrict__ b, sprec* slope) {
+
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	idx size = (idx)Lx * Ly;
+	if (i < size) {
+		int y = i / Lx;
+		int x = i - (idx)y * Lx;
+		prec db[9];
+		bedSlopes(db, i, x, y, Lx, Ly, size, b, NULL);
+		for (int k = 1; k < 9; k++)
+			slope[i + (k - 1) * size] = (sprec)db[k];
 	}
 }
+
+#if LAZY
+// A tile starts active if the free surface is not flat around any of its
+// wet nodes; a flat, still tile is at rest and keeps its feqKernel state.
+__global__ void activeInitKernel(int Lx, int Ly, prec tol, const prec* __restrict__ w,
+	const int* __restrict__ node_types, unsigned char* active) {
+
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)Lx*Ly && node_types[i] != 0) {
+		int y = i / Lx;
+		int x = i - (idx)y * Lx;
+		for (int yi = y - 1; yi <= y + 1; yi++)
+			for (int xi = x - 1; xi <= x + 1; xi++)
+				if (xi >= 0 && xi < Lx && yi >= 0 && yi < Ly && node_types[xi + (idx)yi * Lx] != 0 &&
+					fabs(w[xi + (idx)yi * Lx] - w[i]) > tol)
+					active[tileIndex(i, Lx)] = 1;
+	}
+}
+#endif
+
+#if SPLIT
+// Splits the wet nodes by their SC/BB word: interior nodes (all eight links
+// streaming, no bounce-back) go to the bulk list, the rest to the boundary
+// list. Both lists are in storage order.
+void splitInit(mainDStruct devi, cudaStruct* devEx) {
+	size_t size = (size_t)devi.Lx * devi.Ly;
+	std::vector<unsigned short> SCBB(size);
+	std::vector<idx> bulk, bnd;
+	hipLaunchKernelGGL(auxArraysKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devi.node_types,
+	devEx->SCBB_bin);
+	hipMemcpy(&SCBB[0], devEx->SCBB_bin, size * sizeof(unsigned short), hipMemcpyDeviceToHost);
+	for (size_t i = 0; i < size; i++) {
+		if (SCBB[i] == 255)
+			bulk.push_back((idx)i);
+		else if (SCBB[i] != 0)
+			bnd.push_back((idx)i);
+	}
+	devEx->Nbulk = bulk.size();
+	devEx->Nbnd = bnd.size();
+	fieldMalloc((void**)&devEx->bulk, (bulk.size() + 1) * sizeof(idx), "bulk");
+	fieldMalloc((void**)&devEx->bnd, (bnd.size() + 1) * sizeof(idx), "bnd");
+	if (bulk.size() > 0)
+		hipMemcpy(devEx->bulk, &bulk[0], bulk.size() * sizeof(idx), hipMemcpyHostToDevice);
+	if (bnd.size() > 0)
+		hipMemcpy(devEx->bnd, &bnd[0], bnd.size() * sizeof(idx), hipMemcpyHostToDevice);
+
+	std::cout << "Split: " << bulk.size() << " interior and " << bnd.size() << " boundary nodes." << std::endl;
+}
+
+void splitFree(cudaStruct devEx) {
+	fieldFree(devEx.bulk);
+	fieldFree(devEx.bnd);
+}
+#endif
+
+#ifdef HIP_HOST
+// Estimated pull cost of every node for the host scheduler: dry nodes only
+// test their mask, interior nodes stream all eight links, boundary nodes add
+// bounce-back and the open boundary treatment. Without the SC/BB masks
+// (IN < 4) node_types tells the three apart.
+__global__ void costKernel(int Lx, int Ly, const int* __restrict__ node_types,
+	#if IN == 4
+	const unsigned char* __restrict__ SC_bin, const unsigned char* __restrict__ BB_bin,
+	#elif IN == 5
+	const unsigned short* __restrict__ SCBB_bin,
+	#endif
+	unsigned char* cost) {
+
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)Lx*Ly) {
+		#if IN == 4
+			int word = SC_bin[i] | (BB_bin[i] << 8);
+		#elif IN == 5
+			int word = SCBB_bin[i];
+		#else
+			int word = (node_types[i] == 2) ? 255 : node_types[i];
+		#endif
+		cost[i] = (word == 0) ? COST_DRY : ((word == 255) ? COST_WET : COST_BND);
+	}
+}
+
+void costInit(mainDStruct devi, cudaStruct devEx) {
+	size_t size = (size_t)devi.Lx * devi.Ly;
+	std::vector<unsigned char> cost(size);
+	hipLaunchKernelGGL(costKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, devi.Lx, devi.Ly, devi.node_types,
+	#if IN == 4
+	devEx.SC_bin, devEx.BB_bin,
+	#elif IN == 5
+	devEx.SCBB_bin,
+	#endif
+	&cost[0]);
+	hostSetCost(size, &cost[0]);
+}
+#endif
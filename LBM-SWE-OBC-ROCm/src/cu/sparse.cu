@@ -0,0 +1,115 @@
+#include "hip/hip_runtime.h"
+#include <iostream>
+#include <vector>
+#include "include/sparse.cuh"
+#include "include/setup.cuh"
+#include "include/alloc.cuh"
+#include "../include/structs.h"
+
+#if SPARSE
+// Copies a dense field into the tiles; nodes past the domain edge are zeroed.
+template <typename T>
+__global__ void sparseGatherKernel(int Lx, int Ly, int Ntiles,
+	const int* __restrict__ tileXY, const T* __restrict__ dense, T* tiled) {
+
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)Ntiles * TILE * TILE) {
+		int slot = i / (TILE * TILE);
+		int l = i - (idx)slot * TILE * TILE;
+		int x = tileXY[2 * slot] * TILE + l % TILE;
+		int y = tileXY[2 * slot + 1] * TILE + l / TILE;
+		tiled[i] = (x < Lx && y < Ly) ? dense[x + (idx)y * Lx] : 0;
+	}
+}
+
+__global__ void sparseWKernel(int Lx, int Ly, int Ntiles, const int* __restrict__ tileXY,
+	const prec* __restrict__ h, const prec* __restrict__ b, prec* w) {
+
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)Ntiles * TILE * TILE) {
+		int slot = i / (TILE * TILE);
+		int l = i - (idx)slot * TILE * TILE;
+		int x = tileXY[2 * slot] * TILE + l % TILE;
+		int y = tileXY[2 * slot + 1] * TILE + l / TILE;
+		if (x < Lx && y < Ly)
+			w[x + (idx)y * Lx] = h[i] + b[i];
+	}
+}
+
+// Builds the tile index map from the host node types, allocates only tiles
+// holding at least one wet node and fills their b, h, SC_bin and BB_bin.
+void sparseInit(mainHStruct host, mainDStruct devi, cudaStruct* devEx) {
+	int Lx = devi.Lx, Ly = devi.Ly;
+	int NTx = (Lx + TILE - 1) / TILE, NTy = (Ly + TILE - 1) / TILE;
+	std::vector<int> tileMap(NTx * NTy, -1);
+	std::vector<int> tileXY;
+	int tx, ty, x, y, k;
+	for (ty = 0; ty < NTy; ty++)
+		for (tx = 0; tx < NTx; tx++)
+			for (y = ty * TILE; y < Ly && y < (ty + 1) * TILE && tileMap[tx + ty * NTx] < 0; y++)
+				for (x = tx * TILE; x < Lx && x < (tx + 1) * TILE; x++)
+					if (nodeType(host.node_types, x + (size_t)y * Lx) != 0) {
+						tileMap[tx + ty * NTx] = tileXY.size() / 2;
+						tileXY.push_back(tx);
+						tileXY.push_back(ty);
+						break;
+					}
+	int Ntiles = tileXY.size() / 2;
+	std::vector<int> tileNbr(9 * Ntiles);
+	for (int slot = 0; slot < Ntiles; slot++)
+		for (k = 0; k < 9; k++) {
+			tx = tileXY[2 * slot] + k % 3 - 1;
+			ty = tileXY[2 * slot + 1] + k / 3 - 1;
+			tileNbr[9 * slot + k] = (tx >= 0 && tx < NTx && ty >= 0 && ty < NTy) ? tileMap[tx + ty * NTx] : -1;
+		}
+
+	size_t num_bytes_t = (size_t)Ntiles * TILE * TILE * sizeof(prec);
+	size_t num_bytes_c = (size_t)Ntiles * TILE * TILE * sizeof(unsigned char);
+	devEx->Ntiles = Ntiles;
+	fieldMalloc((void**)&devEx->tileXY, 2 * Ntiles * sizeof(int), "tileXY");
+	fieldMalloc((void**)&devEx->tileNbr, 9 * Ntiles * sizeof(int), "tileNbr");
+	fieldMalloc((void**)&devEx->bt, num_bytes_t, "bt");
+	fieldMalloc((void**)&devEx->h, num_bytes_t, "h");
+	fieldMalloc((void**)&devEx->f1, 9 * num_bytes_t, "f1", FIELD_HUGE);
+	fieldMalloc((void**)&devEx->f2, 9 * num_bytes_t, "f2", FIELD_HUGE);
+	fieldMalloc((void**)&devEx->SC_bin, num_bytes_c, "SC_bin");
+	fieldMalloc((void**)&devEx->BB_bin, num_bytes_c, "BB_bin");
+	hipMemcpy(devEx->tileXY, &tileXY[0], 2 * Ntiles * sizeof(int), hipMemcpyHostToDevice);
+	hipMemcpy(devEx->tileNbr, &tileNbr[0], 9 * Ntiles * sizeof(int), hipMemcpyHostToDevice);
+
+	// Dense temporaries, released once the tiles are filled
+	prec *bd, *hd;
+	int* typesd;
+	unsigned char *SCd, *BBd;
+	fieldMalloc((void**)&bd, (size_t)Lx * Ly * sizeof(prec), "bd");
+	fieldMalloc((void**)&hd, (size_t)Lx * Ly * sizeof(prec), "hd");
+	fieldMalloc((void**)&typesd, (size_t)Lx * Ly * sizeof(int), "typesd");
+	fieldMalloc((void**)&SCd, (size_t)Lx * Ly * sizeof(unsigned char), "SCd");
+	fieldMalloc((void**)&BBd, (size_t)Lx * Ly * sizeof(unsigned char), "BBd");
+	hipMemcpy(bd, host.b, (size_t)Lx * Ly * sizeof(prec), hipMemcpyHostToDevice);
+	uploadTypes(typesd, host.node_types, Lx, Ly, devi.Nblocks);
+	hipLaunchKernelGGL(auxArraysKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, Lx, Ly, typesd,
+	SCd, BBd);
+	hipLaunchKernelGGL(hKernel, dim3(devi.Ngrid), dim3(devi.Nblocks), 0, 0, Lx, Ly, devi.w, bd, hd);
+
+	int Tgrid = int(((size_t)Ntiles * TILE * TILE + devi.Nblocks - 1) / devi.Nblocks);
+	hipLaunchKernelGGL(sparseGatherKernel<prec>, dim3(Tgrid), dim3(devi.Nblocks), 0, 0, Lx, Ly, Ntiles, devEx->tileXY, bd, devEx->bt);
+	hipLaunchKernelGGL(sparseGatherKernel<prec>, dim3(Tgrid), dim3(devi.Nblocks), 0, 0, Lx, Ly, Ntiles, devEx->tileXY, hd, devEx->h);
+	hipLaunchKernelGGL(sparseGatherKernel<unsigned char>, dim3(Tgrid), dim3(devi.Nblocks), 0, 0, Lx, Ly, Ntiles, devEx->tileXY, SCd, devEx->SC_bin);
+	hipLaunchKernelGGL(sparseGatherKernel<unsigned char>, dim3(Tgrid), dim3(devi.Nblocks), 0, 0, Lx, Ly, Ntiles, devEx->tileXY, BBd, devEx->BB_bin);
+	fieldFree(bd);
+	fieldFree(hd);
+	fieldFree(typesd);
+	fieldFree(SCd);
+	fieldFree(BBd);
+
+	std::cout << "Sparse storage: " << Ntiles << " of " << NTx * NTy << " tiles of " << TILE << "x" << TILE
+		<< " allocated (" << (20.0 * num_bytes_t + 2.0 * num_bytes_c) / (1 << 20) << " MB)." << std::endl;
+}
+
+void sparseFree(cudaStruct devEx) {
+	fieldFree(devEx.tileXY);
+	fieldFree(devEx.tileNbr);
+	fieldFree(devEx.bt);
+}
+#endif
@@ -0,0 +1,166 @@
+#include "hip/hip_runtime.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "include/tune.cuh"
+#include "include/alloc.cuh"
+#include "include/LBM.cuh"
+#include "include/setup.cuh"
+#include "../include/structs.h"
+
+#if !defined(_WIN32)
+	#include <unistd.h>
+#endif
+
+// Launch parameters are chosen by timing a few LBMpull steps on the actual
+// grid for every candidate: the block size (Nblocks) and, on the host
+// backend, the number of workers. Results are appended to a cache file, one
+// line per machine, build variant, grid size and wet fraction, and the last
+// matching line is reused by later runs.
+
+typedef struct tuneEntry {
+	std::string machine;
+	std::string variant;
+	int Lx;
+	int Ly;
+	int wet;
+	int Nblocks;
+	int threads;
+	double mlups;
+} tuneEntry;
+
+static std::string machineName() {
+	#if defined(_WIN32)
+		const char* host = getenv("COMPUTERNAME");
+		std::string name = (host != NULL) ? host : "unknown";
+	#else
+		char host[256] = "unknown";
+		gethostname(host, sizeof(host));
+		std::string name = host;
+	#endif
+	hipDeviceProp_t prop;
+	hipGetDeviceProperties(&prop, 0);
+	name = name + "/" + prop.name;
+	std::replace(name.begin(), name.end(), ' ', '_');
+	return name;
+}
+
+static std::string variantName() {
+	std::ostringstream name;
+	name << "IN" << IN << "-BN" << BN << "-PREC" << PREC << "-LAZY" << LAZY << "-SPARSE" << SPARSE << "-ORDER" << ORDER << "-TILE" << TILE << "-SLOPE" << SLOPE << "-INDEX" << INDEX << "-POP" << (POP16 ? 16 : PREC) << "-SPLIT" << SPLIT << "-GHOST" << GHOST << "-OOC" << OOC;
+	return name.str();
+}
+
+static bool readCache(std::string file, const tuneEntry& key, tuneEntry* found) {
+	std::ifstream cache(file.c_str());
+	tuneEntry e;
+	bool hit = false;
+	while (cache >> e.machine >> e.variant >> e.Lx >> e.Ly >> e.wet >> e.Nblocks >> e.threads >> e.mlups)
+		if (e.machine == key.machine && e.variant == key.variant && e.Lx == key.Lx && e.Ly == key.Ly && e.wet == key.wet) {
+			*found = e;
+			hit = true;
+		}
+	return hit;
+}
+
+// Mean time per LBMpull step in ms, from the initial state of setupLevel
+static float timeSteps(mainDStruct devi, cudaStruct devEx, int steps) {
+	hipEvent_t ct1, ct2;
+	float dt;
+	hipEventCreate(&ct1);
+	hipEventCreate(&ct2);
+	setupLevel(devi, devEx);
+	LBMpullLaunch(devi, devEx, 0);
+	LBMpullLaunch(devi, devEx, 1);
+	hipEventRecord(ct1);
+	for (int t = 2; t < steps + 2; t++)
+		LBMpullLaunch(devi, devEx, t);
+	hipEventRecord(ct2);
+	hipEventSynchronize(ct2);
+	hipEventElapsedTime(&dt, ct1, ct2);
+	hipEventDestroy(ct1);
+	hipEventDestroy(ct2);
+	return dt / steps;
+}
+
+void tuneLaunch(mainDStruct* devi, cudaStruct devEx, const unsigned char* node_types, bool retune, std::string file) {
+	size_t size = (size_t)devi->Lx * devi->Ly, wet = 0;
+	for (size_t i = 0; i < size; i++)
+		wet += (nodeType(node_types, i) != 0);
+
+	tuneEntry best;
+	best.machine = machineName();
+	best.variant = variantName();
+	best.Lx = devi->Lx;
+	best.Ly = devi->Ly;
+	best.wet = (int)(100.0 * wet / size + 0.5);
+	if (retune || !readCache(file, best, &best)) {
+		#if SPARSE
+			size_t hsize = (size_t)devEx.Ntiles * TILE * TILE;
+		#elif ORDER
+			size_t hsize = devEx.order.size;
+		#else
+			size_t hsize = ghostSize(devi->Lx, devi->Ly);
+		#endif
+		// LBMpull advances h in place and SPARSE and ORDER do not rebuild it from w
+		prec* h0;
+		fieldMalloc((void**)&h0, hsize * sizeof(prec), "h0");
+		hipMemcpy(h0, devEx.h, hsize * sizeof(prec), hipMemcpyDeviceToDevice);
+
+		int blocks[5] = { 64, 128, 256, 512, 1024 };
+		std::vector<int> threads;
+		#ifdef HIP_HOST
+			int maxThreads = hostThreads();
+			for (int n = 1; n < maxThreads; n *= 2)
+				threads.push_back(n);
+			threads.push_back(maxThreads);
+		#else
+			threads.push_back(0);
+		#endif
+		// About 10^7 node updates per candidate, at least 3 steps
+		int steps = std::max(3, std::min(50, (int)(1e7 / size)));
+		std::cout << "Autotune: " << steps << " steps per candidate" << std::endl;
+		best.mlups = 0;
+		for (size_t n = 0; n < threads.size(); n++)
+			for (int k = 0; k < 5; k++) {
+				#ifdef HIP_HOST
+					hostSetThreads(threads[n]);
+				#endif
+				devi->Nblocks = blocks[k];
+				devi->Ngrid = int((size + blocks[k] - 1) / blocks[k]);
+				double mlups = size / (timeSteps(*devi, devEx, steps) * 1e3);
+				if (mlups > best.mlups) {
+					best.mlups = mlups;
+					best.Nblocks = blocks[k];
+					best.threads = threads[n];
+				}
+			}
+		hipMemcpy(devEx.h, h0, hsize * sizeof(prec), hipMemcpyDeviceToDevice);
+		fieldFree(h0);
+
+		std::ofstream cache(file.c_str(), std::ios::app);
+		if (cache.is_open())
+			cache << best.machine << " " << best.variant << " " << best.Lx << " " << best.Ly << " " << best.wet
+				<< " " << best.Nblocks << " " << best.threads << " " << best.mlups << "\n";
+		else
+			std::cout << "Can't write tuning cache " << file << std::endl;
+		std::cout << "Autotune: tuned " << best.machine << " " << best.variant << ", saved to " << file << std::endl;
+	}
+	else
+		std::cout << "Autotune: cached in " << file << std::endl;
+
+	devi->Nblocks = best.Nblocks;
+	devi->Ngrid = int((size + best.Nblocks - 1) / best.Nblocks);
+	#ifdef HIP_HOST
+		hostSetThreads(best.threads);
+	#endif
+	std::cout << std::fixed << std::setprecision(1) << "Autotune: Nblocks = " << best.Nblocks;
+	if (best.threads > 0)
+		std::cout << ", " << best.threads << " threads";
+	std::cout << " (" << best.mlups << " MLUPS)" << std::endl;
+}
@@ -0,0 +1,160 @@
+#ifndef HIP_HOST_RUNTIME_H
+#define HIP_HOST_RUNTIME_H
+
+// Host backend (make host): the part of the HIP runtime used by the solver,
+// implemented on the CPU so the same kernels build with g++. Device memory is
+// host memory, and every launch runs its blocks on a pool of worker threads
+// (LBM_THREADS, all hardware threads by default) and returns when they are done.
+
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <functional>
+
+#define HIP_HOST 1
+
+#define __global__
+#define __device__
+#define __host__
+
+typedef struct dim3 {
+	unsigned int x;
+	unsigned int y;
+	unsigned int z;
+	constexpr dim3(unsigned int x = 1, unsigned int y = 1, unsigned int z = 1) : x(x), y(y), z(z) {}
+} dim3;
+
+inline thread_local dim3 threadIdx(0, 0, 0);
+inline thread_local dim3 blockIdx(0, 0, 0);
+inline thread_local dim3 blockDim;
+inline thread_local dim3 gridDim;
+
+int hostThreads();
+
+// Limits the workers taking part in launches to n, at most the pool size.
+void hostSetThreads(int n);
+
+// Runs body(begin, end) over [0, n) on the active workers with work
+// stealing. cost, if not NULL, holds the n + 1 prefix sums of the estimated
+// cost of each item and balances the initial ranges and the steals.
+void hostParallel(int n, const std::function<void(int, int)>& body, const double* cost = NULL);
+
+// Registers the estimated cost of each of the n nodes of a grid (setupLevel);
+// launches of ceil(n / block) blocks are then scheduled by block cost.
+void hostSetCost(size_t n, const unsigned char* cost);
+
+// Prefix sums of the block costs for a launch, NULL if no grid matches
+const double* hostBlockCost(int grid, int block);
+
+// Clears and prints the fraction of launch time each worker spent working,
+// and the ranges it stole
+void hostBusyReset();
+
+void hostBusyReport();
+
+template <class K, class... A>
+void hostLaunch(dim3 grid, dim3 block, K kernel, A... args) {
+	hostParallel(grid.x, [&](int begin, int end) {
+		gridDim = grid;
+		blockDim = block;
+		for (int bx = begin; bx < end; bx++) {
+			blockIdx.x = bx;
+			for (unsigned int tx = 0; tx < block.x; tx++) {
+				threadIdx.x = tx;
+				kernel(args...);
+			}
+		}
+	}, hostBlockCost(grid.x, block.x));
+}
+
+// Arguments are evaluated once per launch; the lambda gives the kernel call a
+// static target so it can be inlined into the node loop.
+#define hipLaunchKernelGGL(kernel, grid, block, shmem, stream, ...) \
+	hostLaunch(grid, block, [](auto... a) { kernel(a...); }, __VA_ARGS__)
+
+typedef int hipError_t;
+#define hipSuccess 0
+
+typedef enum hipMemcpyKind {
+	hipMemcpyHostToHost,
+	hipMemcpyHostToDevice,
+	hipMemcpyDeviceToHost,
+	hipMemcpyDeviceToDevice
+} hipMemcpyKind;
+
+typedef enum hipFuncCache_t {
+	hipFuncCachePreferNone,
+	hipFuncCachePreferShared,
+	hipFuncCachePreferL1,
+	hipFuncCachePreferEqual
+} hipFuncCache_t;
+
+// Zeroed like fresh device pages; the kernels first touch them from the
+// worker whose initial range holds each block.
+inline hipError_t hipMalloc(void** ptr, size_t bytes) {
+	*ptr = calloc(bytes ? bytes : 1, 1);
+	return hipSuccess;
+}
+
+inline hipError_t hipFree(void* ptr) {
+	free(ptr);
+	return hipSuccess;
+}
+
+inline hipError_t hipMemcpy(void* dst, const void* src, size_t bytes, hipMemcpyKind) {
+	memcpy(dst, src, bytes);
+	return hipSuccess;
+}
+
+inline hipError_t hipMemset(void* dst, int value, size_t bytes) {
+	memset(dst, value, bytes);
+	return hipSuccess;
+}
+
+inline hipError_t hipDeviceSynchronize() {
+	return hipSuccess;
+}
+
+inline hipError_t hipFuncSetCacheConfig(const void*, hipFuncCache_t) {
+	return hipSuccess;
+}
+
+typedef struct hipDeviceProp_t {
+	char name[256];
+	int multiProcessorCount;
+} hipDeviceProp_t;
+
+inline hipError_t hipGetDeviceProperties(hipDeviceProp_t* prop, int) {
+	memset(prop, 0, sizeof(hipDeviceProp_t));
+	strcpy(prop->name, "host");
+	prop->multiProcessorCount = hostThreads();
+	return hipSuccess;
+}
+
+typedef std::chrono::steady_clock::time_point* hipEvent_t;
+
+inline hipError_t hipEventCreate(hipEvent_t* event) {
+	*event = new std::chrono::steady_clock::time_point();
+	return hipSuccess;
+}
+
+inline hipError_t hipEventDestroy(hipEvent_t event) {
+	delete event;
+	return hipSuccess;
+}
+
+inline hipError_t hipEventRecord(hipEvent_t event, int stream = 0) {
+	*event = std::chrono::steady_clock::now();
+	return hipSuccess;
+}
+
+inline hipError_t hipEventSynchronize(hipEvent_t) {
+	return hipSuccess;
+}
+
+inline hipError_t hipEventElapsedTime(float* ms, hipEvent_t start, hipEvent_t stop) {
+	*ms = std::chrono::duration<float, std::milli>(*stop - *start).count();
+	return hipSuccess;
+}
+
+#endif
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <iomanip>
+#include <iostream>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "hip/hip_runtime.h"
+#include "../include/perf.h"
+
+#if PERF
+#define PERF_TASK_CLOCK 0
+#define PERF_CYCLES 1
+#define PERF_INSTRUCTIONS 2
+#define PERF_L1D_MISSES 3
+#define PERF_LLC_MISSES 4
+#define PERF_FP_SCALAR 5
+#define PERF_FP_PACKED 6
+#define PERF_NCOUNTERS 7
+
+static const char* phaseNames[PERF_NPHASES] = { "setup", "pull", "refine", "activity", "sample", "write" };
+
+// Counters are opened with inherit before the worker pool starts, so each
+// read covers the calling thread and every worker.
+static struct perfState {
+	bool ready;
+	int fd[PERF_NCOUNTERS];
+	long long start[PERF_NPHASES][PERF_NCOUNTERS];
+	long long total[PERF_NPHASES][PERF_NCOUNTERS];
+	long long calls[PERF_NPHASES];
+} perf;
+
+static int perfOpen(unsigned int type, unsigned long long config) {
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.type = type;
+	attr.size = sizeof(attr);
+	attr.config = config;
+	attr.inherit = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static bool intelCPU() {
+	FILE* fp = fopen("/proc/cpuinfo", "r");
+	char line[256];
+	bool intel = false;
+	while (fp != NULL && fgets(line, sizeof(line), fp) != NULL)
+		if (strncmp(line, "vendor_id", 9) == 0) {
+			intel = strstr(line, "GenuineIntel") != NULL;
+			break;
+		}
+	if (fp != NULL)
+		fclose(fp);
+	return intel;
+}
+
+static void perfInit() {
+	unsigned long long l1d = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+		(PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	perf.fd[PERF_TASK_CLOCK] = perfOpen(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK);
+	perf.fd[PERF_CYCLES] = perfOpen(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+	perf.fd[PERF_INSTRUCTIONS] = perfOpen(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+	perf.fd[PERF_L1D_MISSES] = perfOpen(PERF_TYPE_HW_CACHE, l1d);
+	perf.fd[PERF_LLC_MISSES] = perfOpen(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+	// FP_ARITH_INST_RETIRED (event 0xC7): scalar and packed umasks
+	bool intel = intelCPU();
+	perf.fd[PERF_FP_SCALAR] = intel ? perfOpen(PERF_TYPE_RAW, 0x03C7) : -1;
+	perf.fd[PERF_FP_PACKED] = intel ? perfOpen(PERF_TYPE_RAW, 0xFCC7) : -1;
+	perf.ready = true;
+	hostThreads();
+}
+
+// Scaled for multiplexing; -1 if the counter is unavailable
+static long long perfRead(int c) {
+	unsigned long long v[3];
+	if (perf.fd[c] < 0 || read(perf.fd[c], v, sizeof(v)) != sizeof(v))
+		return -1;
+	if (v[2] == 0)
+		return 0;
+	return (long long)((double)v[0] * v[1] / v[2]);
+}
+
+void perfBegin(int phase) {
+	if (!perf.ready)
+		perfInit();
+	for (int c = 0; c < PERF_NCOUNTERS; c++)
+		perf.start[phase][c] = perfRead(c);
+}
+
+void perfEnd(int phase) {
+	for (int c = 0; c < PERF_NCOUNTERS; c++) {
+		long long v = perfRead(c);
+		if (v < 0 || perf.start[phase][c] < 0 || perf.total[phase][c] < 0)
+			perf.total[phase][c] = -1;
+		else
+			perf.total[phase][c] += v - perf.start[phase][c];
+	}
+	perf.calls[phase]++;
+}
+
+static void perfColumn(double value, bool valid, int width, int digits) {
+	if (valid)
+		std::cout << std::setw(width) << std::setprecision(digits) << value;
+	else
+		std::cout << std::setw(width) << "n/a";
+}
+
+void perfReport(long long updates) {
+	if (!perf.ready)
+		return;
+	std::cout << std::endl << "Counters per lattice update (" << updates << " updates, "
+			  << hostThreads() << " threads):" << std::endl;
+	std::cout << std::setw(9) << "phase" << std::setw(7) << "calls" << std::setw(11) << "time[ms]"
+			  << std::setw(10) << "cycles" << std::setw(10) << "instr" << std::setw(7) << "IPC"
+			  << std::setw(10) << "L1D miss" << std::setw(10) << "LLC miss" << std::setw(10) << "DRAM[B]"
+			  << std::setw(8) << "vec[%]" << std::endl;
+	std::cout << std::fixed;
+	for (int p = 0; p < PERF_NPHASES; p++) {
+		if (perf.calls[p] == 0)
+			continue;
+		const long long* t = perf.total[p];
+		std::cout << std::setw(9) << phaseNames[p] << std::setw(7) << perf.calls[p];
+		perfColumn(1e-6 * t[PERF_TASK_CLOCK], t[PERF_TASK_CLOCK] >= 0, 11, 1);
+		perfColumn((double)t[PERF_CYCLES] / updates, t[PERF_CYCLES] >= 0, 10, 1);
+		perfColumn((double)t[PERF_INSTRUCTIONS] / updates, t[PERF_INSTRUCTIONS] >= 0, 10, 1);
+		perfColumn((double)t[PERF_INSTRUCTIONS] / t[PERF_CYCLES], t[PERF_CYCLES] > 0 && t[PERF_INSTRUCTIONS] >= 0, 7, 2);
+		perfColumn((double)t[PERF_L1D_MISSES] / updates, t[PERF_L1D_MISSES] >= 0, 10, 2);
+		perfColumn((double)t[PERF_LLC_MISSES] / updates, t[PERF_LLC_MISSES] >= 0, 10, 2);
+		// every last-level miss moves one 64-byte line to or from DRAM
+		perfColumn(64.0 * t[PERF_LLC_MISSES] / updates, t[PERF_LLC_MISSES] >= 0, 10, 1);
+		perfColumn(100.0 * t[PERF_FP_PACKED] / (t[PERF_FP_PACKED] + t[PERF_FP_SCALAR]),
+			t[PERF_FP_SCALAR] >= 0 && t[PERF_FP_PACKED] >= 0 && t[PERF_FP_PACKED] + t[PERF_FP_SCALAR] > 0, 8, 1);
+		std::cout << std::endl;
+	}
+	for (int c = 0; c < PERF_NCOUNTERS; c++)
+		if (perf.fd[c] >= 0)
+			close(perf.fd[c]);
+	perf.ready = false;
+}
+#endif
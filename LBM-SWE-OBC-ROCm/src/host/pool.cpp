@@ -0,0 +1,272 @@
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "hip/hip_runtime.h"
+
+// Persistent workers for hostParallel. The calling thread is worker 0, so
+// LBM_THREADS=1 runs every kernel inline without touching the pool. Launches
+// are split among the first active workers; the rest keep sleeping.
+// Each worker starts on a contiguous range of items holding an equal share
+// of the estimated cost and takes items from its front. A worker that runs
+// out steals the back half, by cost, of the range with the most cost left,
+// so ranges stay contiguous for the caches and first touch while land-heavy
+// ranges are drained by the others.
+static double seconds(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+	return std::chrono::duration<double>(b - a).count();
+}
+
+// Items [begin, end) not yet taken, packed for compare-and-swap
+static inline unsigned long long packRange(int begin, int end) {
+	return ((unsigned long long)(unsigned int)begin << 32) | (unsigned int)end;
+}
+
+static inline int rangeBegin(unsigned long long r) {
+	return (int)(r >> 32);
+}
+
+static inline int rangeEnd(unsigned long long r) {
+	return (int)(r & 0xffffffffu);
+}
+
+typedef struct alignas(64) hostSlot {
+	std::atomic<unsigned long long> range;
+	// seconds working and seconds of the launches taken part in, steals
+	double busy;
+	double wall;
+	unsigned long long steals;
+} hostSlot;
+
+static struct hostPool {
+	std::vector<std::thread> workers;
+	std::vector<hostSlot> slots;
+	std::mutex m;
+	std::condition_variable wake;
+	std::condition_variable done;
+	const std::function<void(int, int)>* body = NULL;
+	const double* cost = NULL;
+	int n = 0;
+	int nthreads = 0;
+	int active = 0;
+	int used = 0;
+	int pending = 0;
+	unsigned long long launch = 0;
+	unsigned long long launches = 0;
+	bool stop = false;
+
+	// Estimated cost of items [begin, end)
+	double left(int begin, int end) {
+		if (begin >= end)
+			return 0;
+		return (cost != NULL) ? cost[end] - cost[begin] : end - begin;
+	}
+
+	// First item of [begin, end) past half of its cost
+	int half(int begin, int end) {
+		if (cost == NULL)
+			return begin + (end - begin) / 2;
+		double h = 0.5 * (cost[begin] + cost[end]);
+		return (int)(std::lower_bound(cost + begin + 1, cost + end, h) - cost) - 1;
+	}
+
+	bool steal(int p) {
+		while (true) {
+			int victim = -1;
+			double most = 0;
+			for (int q = 0; q < used; q++) {
+				unsigned long long r = slots[q].range.load(std::memory_order_relaxed);
+				double c = left(rangeBegin(r), rangeEnd(r));
+				if (q != p && c > most) {
+					most = c;
+					victim = q;
+				}
+			}
+			if (victim < 0)
+				return false;
+			unsigned long long r = slots[victim].range.load();
+			int begin = rangeBegin(r), end = rangeEnd(r);
+			if (begin >= end)
+				continue;
+			int mid = std::max(begin, half(begin, end));
+			if (slots[victim].range.compare_exchange_weak(r, packRange(begin, mid))) {
+				slots[p].range.store(packRange(mid, end));
+				slots[p].steals++;
+				return true;
+			}
+		}
+	}
+
+	void run(int p) {
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		do {
+			unsigned long long r = slots[p].range.load();
+			while (rangeBegin(r) < rangeEnd(r)) {
+				int item = rangeBegin(r);
+				if (slots[p].range.compare_exchange_weak(r, packRange(item + 1, rangeEnd(r)))) {
+					(*body)(item, item + 1);
+					r = slots[p].range.load();
+				}
+			}
+		} while (steal(p));
+		slots[p].busy += seconds(t0, std::chrono::steady_clock::now());
+	}
+
+	void worker(int p) {
+		unsigned long long seen = 0;
+		std::unique_lock<std::mutex> lock(m);
+		while (true) {
+			wake.wait(lock, [&] { return stop || launch != seen; });
+			if (stop)
+				return;
+			seen = launch;
+			// used is set with launch, so a late wake-up never joins a finished launch
+			if (p >= used)
+				continue;
+			lock.unlock();
+			run(p);
+			lock.lock();
+			if (--pending == 0)
+				done.notify_one();
+		}
+	}
+
+	void start() {
+		const char* env = getenv("LBM_THREADS");
+		nthreads = (env != NULL) ? atoi(env) : (int)std::thread::hardware_concurrency();
+		if (nthreads < 1)
+			nthreads = 1;
+		active = nthreads;
+		slots = std::vector<hostSlot>(nthreads);
+		std::cout << "Host backend: " << nthreads << " threads" << std::endl;
+		for (int p = 1; p < nthreads; p++)
+			workers.push_back(std::thread(&hostPool::worker, this, p));
+	}
+
+	~hostPool() {
+		{
+			std::lock_guard<std::mutex> lock(m);
+			stop = true;
+		}
+		wake.notify_all();
+		for (auto& th : workers)
+			th.join();
+	}
+} pool;
+
+int hostThreads() {
+	if (pool.nthreads == 0)
+		pool.start();
+	return pool.active;
+}
+
+void hostSetThreads(int n) {
+	if (pool.nthreads == 0)
+		pool.start();
+	std::lock_guard<std::mutex> lock(pool.m);
+	pool.active = std::max(1, std::min(n, pool.nthreads));
+}
+
+void hostParallel(int n, const std::function<void(int, int)>& body, const double* cost) {
+	if (hostThreads() == 1 || n < 2) {
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		if (n > 0)
+			body(0, n);
+		double s = seconds(t0, std::chrono::steady_clock::now());
+		pool.slots[0].busy += s;
+		pool.slots[0].wall += s;
+		pool.launches++;
+		return;
+	}
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+	{
+		std::lock_guard<std::mutex> lock(pool.m);
+		pool.body = &body;
+		pool.cost = cost;
+		pool.n = n;
+		pool.used = std::min(pool.active, n);
+		double total = pool.left(0, n);
+		int begin = 0;
+		for (int p = 0; p < pool.used; p++) {
+			int end = n;
+			if (p + 1 < pool.used)
+				end = (cost != NULL) ? (int)(std::lower_bound(cost, cost + n + 1, total * (p + 1) / pool.used) - cost)
+					: (int)((long long)n * (p + 1) / pool.used);
+			end = std::max(begin, std::min(end, n));
+			pool.slots[p].range.store(packRange(begin, end));
+			begin = end;
+		}
+		pool.pending = pool.used - 1;
+		pool.launch++;
+	}
+	pool.wake.notify_all();
+	pool.run(0);
+	std::unique_lock<std::mutex> lock(pool.m);
+	pool.done.wait(lock, [] { return pool.pending == 0; });
+	double s = seconds(t0, std::chrono::steady_clock::now());
+	for (int p = 0; p < pool.used; p++)
+		pool.slots[p].wall += s;
+	pool.launches++;
+}
+
+// Node costs by count of nodes, and their prefix sums over launch blocks
+// by block size, built on the first launch that uses them
+typedef struct hostCost {
+	std::vector<unsigned char> node;
+	std::map<int, std::vector<double> > blocks;
+} hostCost;
+
+static std::map<size_t, hostCost> costs;
+
+void hostSetCost(size_t n, const unsigned char* cost) {
+	hostCost& c = costs[n];
+	c.node.assign(cost, cost + n);
+	c.blocks.clear();
+}
+
+const double* hostBlockCost(int grid, int block) {
+	for (std::map<size_t, hostCost>::iterator it = costs.begin(); it != costs.end(); ++it) {
+		size_t n = it->first;
+		if ((n + block - 1) / block != (size_t)grid)
+			continue;
+		std::vector<double>& prefix = it->second.blocks[block];
+		if (prefix.empty()) {
+			prefix.assign(grid + 1, 0);
+			for (size_t i = 0; i < n; i++)
+				prefix[i / block + 1] += it->second.node[i];
+			for (int b = 0; b < grid; b++)
+				prefix[b + 1] += prefix[b];
+		}
+		return &prefix[0];
+	}
+	return NULL;
+}
+
+void hostBusyReset() {
+	hostThreads();
+	for (int p = 0; p < pool.nthreads; p++) {
+		pool.slots[p].busy = 0;
+		pool.slots[p].wall = 0;
+		pool.slots[p].steals = 0;
+	}
+	pool.launches = 0;
+}
+
+void hostBusyReport() {
+	hostThreads();
+	std::cout << std::endl << "Busy fraction per thread (" << pool.launches << " launches):" << std::endl;
+	std::cout << std::setw(7) << "thread" << std::setw(10) << "busy[%]" << std::setw(10) << "steals" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	for (int p = 0; p < pool.nthreads; p++) {
+		if (pool.slots[p].wall == 0)
+			continue;
+		std::cout << std::setw(7) << p << std::setw(10) << 100 * pool.slots[p].busy / pool.slots[p].wall
+				  << std::setw(10) << pool.slots[p].steals << std::endl;
+	}
+}
@@ -0,0 +1,70 @@
+#ifndef ORDERING_H
+#define ORDERING_H
+
+// Included by structs.h, after TILE and idx
+
+#if defined(__HIPCC__) || defined(__CUDACC__)
+	#define HOSTDEV __host__ __device__
+#else
+	#define HOSTDEV
+#endif
+
+// Node storage orderings. ORDER_ROW is the plain x + y*Lx layout of the
+// dense kernels. The curve orderings store the grid as TILE x TILE tiles,
+// row-major inside each tile, with the tiles laid out along a Morton (Z) or
+// Hilbert curve so that x- and y-neighbours share cache lines and pages.
+// Partial tiles on the right and top edges are padded, so size >= Lx*Ly.
+// The solver stores its fields in curve order with ORDER=1 or 2 (IN=4).
+#define ORDER_ROW 0
+#define ORDER_MORTON 1
+#define ORDER_HILBERT 2
+
+typedef struct orderStruct {
+	int type;
+	int Lx;
+	int Ly;
+	int NTx;
+	int NTy;
+	idx size;
+	int* tileSlot;
+	int* tileXY;
+} orderStruct;
+
+void orderInit(orderStruct*, int, int, int);
+
+void orderFree(orderStruct*);
+
+const char* orderName(int);
+
+HOSTDEV inline idx orderIndex(const orderStruct& o, int x, int y) {
+	if (o.type == ORDER_ROW)
+		return x + (idx)y * o.Lx;
+	idx slot = o.tileSlot[x / TILE + (y / TILE) * o.NTx];
+	return slot * TILE * TILE + (x % TILE) + (y % TILE) * TILE;
+}
+
+// Inverse of orderIndex; padding nodes give x >= Lx or y >= Ly.
+HOSTDEV inline void orderCoords(const orderStruct& o, idx i, int* x, int* y) {
+	if (o.type == ORDER_ROW) {
+		*y = i / o.Lx;
+		*x = i - (idx)*y * o.Lx;
+		return;
+	}
+	int slot = i / (TILE * TILE);
+	int l = i - (idx)slot * TILE * TILE;
+	*x = o.tileXY[2 * slot] * TILE + l % TILE;
+	*y = o.tileXY[2 * slot + 1] * TILE + l / TILE;
+}
+
+// Index of node (x + dx, y + dy) given the index i of (x, y), with |dx|, |dy| <= 1
+// and the neighbour inside the domain. Only tile-crossing lookups touch tileSlot.
+HOSTDEV inline idx orderNeighbour(const orderStruct& o, idx i, int x, int y, int dx, int dy) {
+	if (o.type == ORDER_ROW)
+		return i + dx + dy * (idx)o.Lx;
+	int lx = x % TILE + dx, ly = y % TILE + dy;
+	if (lx >= 0 && lx < TILE && ly >= 0 && ly < TILE)
+		return i + dx + dy * TILE;
+	return orderIndex(o, x + dx, y + dy);
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef PERF_H
+#define PERF_H
+
+// Hardware counters per solver phase on the host build (make host PERF=1),
+// read with perf_event_open around the phase boundaries of LBMTimeStep and
+// reported per lattice update at the end of LBM(). Counters the kernel or
+// CPU does not provide are shown as n/a. With PERF=0 the macros vanish.
+
+#ifndef PERF
+#define PERF 0
+#endif
+
+// LBMpull fuses streaming, boundary handling, moments and collision per
+// node, so they are measured as one phase.
+#define PERF_SETUP 0
+#define PERF_PULL 1
+#define PERF_REFINE 2
+#define PERF_ACTIVITY 3
+#define PERF_SAMPLE 4
+#define PERF_WRITE 5
+#define PERF_NPHASES 6
+
+#if PERF
+	#ifndef HIP_HOST
+		#error "PERF counters need the host build (make host PERF=1)"
+	#endif
+
+	void perfBegin(int);
+
+	void perfEnd(int);
+
+	void perfReport(long long);
+
+	#define PERF_BEGIN(phase) perfBegin(phase)
+	#define PERF_END(phase) perfEnd(phase)
+	#define PERF_REPORT(updates) perfReport(updates)
+#else
+	#define PERF_BEGIN(phase)
+	#define PERF_END(phase)
+	#define PERF_REPORT(updates)
+#endif
+
+#endif
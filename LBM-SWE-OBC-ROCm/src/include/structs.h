@@ -1,6 +1,8 @@
 #ifndef STRUCTS_H
 #define STRUCTS_H
 
+#include <string>
+
 #define FILE_BATCH_SIZE 1000000
 #ifndef PREC  
 #define PREC 64
@@ -11,17 +13,121 @@
 #ifndef BN
 #define BN 2
 #endif
+#ifndef LAZY
+#define LAZY 0
+#endif
+#ifndef TILE
+#define TILE 16
+#endif
+#ifndef SPARSE
+#define SPARSE 0
+#endif
+#if SPARSE && (IN != 4 || LAZY)
+#error "SPARSE storage needs IN=4 and LAZY=0"
+#endif
+#ifndef INDEX
+#define INDEX 32
+#endif
+#ifndef SLOPE
+#define SLOPE 0
+#endif
+#if SPARSE && SLOPE
+#error "SLOPE needs dense storage (SPARSE=0)"
+#endif
+#ifndef POP16
+#define POP16 0
+#endif
+#if POP16 && (SPARSE || LAZY)
+#error "POP16 needs dense storage and LAZY=0"
+#endif
+#ifndef SPLIT
+#define SPLIT 0
+#endif
+#if SPLIT && (IN != 5 || LAZY)
+#error "SPLIT needs IN=5 and LAZY=0"
+#endif
+#ifndef GHOST
+#define GHOST 0
+#endif
+#if GHOST && (IN != 4 || SPARSE || LAZY || POP16 || !SLOPE)
+#error "GHOST needs IN=4, dense storage, LAZY=0, POP16=0 and stored slopes (SLOPE=32 or 64)"
+#endif
+#ifndef OOC
+#define OOC 0
+#endif
+#if OOC && (IN != 4 || SPARSE || LAZY || POP16 || GHOST)
+#error "OOC needs IN=4, dense storage, LAZY=0, POP16=0 and GHOST=0"
+#endif
+// Node ordering of the stored fields, ORDER_ROW (0), ORDER_MORTON or ORDER_HILBERT (ordering.h)
+#ifndef ORDER
+#define ORDER 0
+#endif
+#if ORDER && (IN != 4 || SPARSE || LAZY || SLOPE || POP16 || GHOST || OOC)
+#error "ORDER needs IN=4, dense storage, LAZY=0, SLOPE=0, POP16=0, GHOST=0 and OOC=0"
+#endif
 #if PREC==64
 	typedef double prec;
 #else
 	typedef float prec;
 #endif
+// Node index type; INDEX=64 for grids with 2^31 or more populations
+#if INDEX==64
+	typedef long long idx;
+#else
+	typedef int idx;
+#endif
+// Stored bed slopes; SLOPE=32 or 64 bits per link, SLOPE=0 recomputes them
+#if SLOPE==64
+	typedef double sprec;
+#else
+	typedef float sprec;
+#endif
+// Stored populations; POP16=1 keeps 16-bit deviations from the rest state
+#if POP16
+	typedef short pop;
+#else
+	typedef prec pop;
+#endif
+
+#include "ordering.h"
+
+// Host node types (0 dry, 1 boundary, 2 interior) take 2 bits each, four
+// nodes per byte; the device keeps one int per node for its kernels
+#define TYPES_BYTES(n) (((size_t)(n) + 3) / 4)
+
+inline int nodeType(const unsigned char* types, size_t i) {
+	return (types[i / 4] >> (2 * (i % 4))) & 3;
+}
+
+// Collision operator, Collision = BGK, TRT or MRT in the configuration
+#define COLL_BGK 0
+#define COLL_TRT 1
+#define COLL_MRT 2
+
+typedef struct collStruct {
+	int model;
+	prec tau;
+	// TRT: relaxation time of the odd part from the magic parameter
+	// (tau - 1/2)(tauMinus - 1/2)
+	prec magic;
+	prec tauMinus;
+	// MRT: rates of the energy, energy squared and heat flux moments
+	prec sE;
+	prec sEps;
+	prec sQ;
+} collStruct;
+
+// Sets tau, and the TRT odd relaxation time that keeps the magic parameter
+inline void collSetTau(collStruct* coll, prec tau) {
+	coll->tau = tau;
+	coll->tauMinus = 0.5 + coll->magic / (tau - 0.5);
+}
 
 typedef struct mainHStruct {
-	int* node_types;
+	unsigned char* node_types;
 	prec* b;
 	prec* w;
-	int* TSind;
+	idx* TSind;
 	prec* TSdata;
 } mainHStruct;
 
@@ -35,25 +141,74 @@ typedef struct mainDStruct {
 	int* node_types;
 	prec* b;
 	prec* w; 
-	int* TSind;
+	idx* TSind;
 	prec* TSdata;
 } mainDStruct;
 
 typedef struct cudaStruct {
-	prec tau;
+	collStruct coll;
 	prec g;
 	prec e;
-	int* ex;
-	int* ey;
+	prec activeTol;
 	#if IN == 3
 		unsigned char* Arr_tri;
 	#elif IN == 4
 		unsigned char* SC_bin;
 		unsigned char* BB_bin;
+	#elif IN == 5
+		// SC_bin in the low byte, BB_bin in the high byte
+		unsigned short* SCBB_bin;
+	#endif
+	#if LAZY
+		unsigned char* active;
+		prec* h0;
+	#endif
+	#if SPARSE
+		int Ntiles;
+		int* tileXY;
+		int* tileNbr;
+	#endif
+	#if ORDER
+		orderStruct order;
+	#endif
+	#if SPARSE || ORDER
+		// b in storage order
+		prec* bt;
+	#endif
+	#if SLOPE
+		sprec* slope;
+	#endif
+	#if SPLIT
+		// interior nodes, all links streaming, and the other wet nodes
+		idx Nbulk;
+		idx Nbnd;
+		idx* bulk;
+		idx* bnd;
+	#endif
+	#if POP16
+		// scales of f1 and f2 per tile and direction, keep/grow flags,
+		// still-water level of every tile
+		float* s1;
+		float* s2;
+		unsigned char* popFlags;
+		prec* wt;
 	#endif
 	prec* h;
-	prec* f1;
-	prec* f2;
+	pop* f1;
+	pop* f2;
 } cudaStruct;
 
+typedef struct patchStruct {
+	std::string name;
+	std::string outputdir;
+	int ratio;
+	int ox;
+	int oy;
+	prec alphaC2F;
+	prec alphaF2C;
+	mainHStruct host;
+	mainDStruct devi;
+	cudaStruct devEx;
+} patchStruct;
+
 #endif
@@ -7,10 +7,16 @@
 #include <stdlib.h>
 #include <iostream>
 #include <fstream>
+#include <chrono>
 #include <hip/hip_runtime.h>
 #include "include/structs.h"
 #include "cpp/include/files.h"
 #include "cu/include/LBM.cuh"
+#include "cu/include/setup.cuh"
+#include "cu/include/sparse.cuh"
+#include "cu/include/ordering.cuh"
+#include "cu/include/tune.cuh"
+#include "cu/include/alloc.cuh"
 #include <time.h>
 #include <sys/types.h> 
 #include <sys/stat.h>
@@ -19,44 +25,89 @@
 #include <direct.h> 
 #endif
 
-void freemem(mainHStruct host, mainDStruct devi, cudaStruct devEx) {
-	/*delete[] host.b;
-	delete[] host.w;
-	delete[] host.ux;
-	delete[] host.uy;
-	delete[] host.node_types;
-	*/
-	hipFree(devi.b);
-	hipFree(devi.w);
-	hipFree(devi.node_types);
-	hipFree(devi.TSind);
-	hipFree(devi.TSdata);
-
-	hipFree(devEx.ex);
-	hipFree(devEx.ey);
-	hipFree(devEx.h);
-	hipFree(devEx.f1);
-	hipFree(devEx.f2);
+void freemem(mainHStruct host, mainDStruct devi, cudaStruct devEx, patchStruct* patches, int NP) {
+	hostFieldFree(host.b);
+	hostFieldFree(host.w);
+	hostFieldFree(host.node_types);
+	hostFieldFree(host.TSdata);
+	hostFieldFree(host.TSind);
+	fieldFree(devi.b);
+	fieldFree(devi.w);
+	fieldFree(devi.node_types);
+	fieldFree(devi.TSind);
+	fieldFree(devi.TSdata);
+
+	#if SPARSE
+		sparseFree(devEx);
+	#endif
+	#if ORDER
+		orderedFree(devEx);
+	#endif
+	#if SPLIT
+		splitFree(devEx);
+	#endif
+	fieldFree(devEx.h);
+	fieldFree(devEx.f1);
+	fieldFree(devEx.f2);
 	#if IN == 3
-		hipFree(devEx.Arr_tri);
+		fieldFree(devEx.Arr_tri);
 	#elif IN == 4
-		hipFree(devEx.SC_bin);
-		hipFree(devEx.BB_bin);
+		fieldFree(devEx.SC_bin);
+		fieldFree(devEx.BB_bin);
+	#elif IN == 5
+		fieldFree(devEx.SCBB_bin);
+	#endif
+	#if LAZY
+		fieldFree(devEx.active);
+		fieldFree(devEx.h0);
+	#endif
+	#if POP16
+		fieldFree(devEx.s1);
+		fieldFree(devEx.s2);
+		fieldFree(devEx.popFlags);
+		fieldFree(devEx.wt);
 	#endif
+	#if SLOPE
+		fieldFree(devEx.slope);
+	#endif
+	for (int p = 0; p < NP; p++) {
+		hostFieldFree(patches[p].host.b);
+		hostFieldFree(patches[p].host.w);
+		hostFieldFree(patches[p].host.node_types);
+		fieldFree(patches[p].devi.b);
+		fieldFree(patches[p].devi.w);
+		fieldFree(patches[p].devi.node_types);
+		fieldFree(patches[p].devEx.h);
+		fieldFree(patches[p].devEx.f1);
+		fieldFree(patches[p].devEx.f2);
+		#if IN == 3
+			fieldFree(patches[p].devEx.Arr_tri);
+		#elif IN == 4
+			fieldFree(patches[p].devEx.SC_bin);
+			fieldFree(patches[p].devEx.BB_bin);
+		#elif IN == 5
+			fieldFree(patches[p].devEx.SCBB_bin);
+		#endif
+		#if SLOPE
+			fieldFree(patches[p].devEx.slope);
+		#endif
+	}
+	delete[] patches;
 }
 
-void getTSIndex(int* TSind, prec* TSx, prec* TSy, prec x0, prec y0,
-	int* bb, int Lx, int Ly, prec Dx, int NTS) {
-	int k, min_i, min_x, min_y;
+void getTSIndex(idx* TSind, prec* TSx, prec* TSy, prec x0, prec y0,
+	const unsigned char* types, int Lx, int Ly, prec Dx, int NTS) {
+	int k, min_x, min_y;
+	idx min_i;
 	std::cout << "TS nodes located in dry zones:" << std::endl;
 	std::cout << std::fixed << std::setprecision(2);
 	for (k = 0; k < NTS; k++) {
 		std::cout << "Node at (x = " << TSx[k] << ", y = " << TSy[k] << "). ";
 		min_x = (int)(TSx[k] - x0) / Dx;
 		min_y = (int)(TSy[k] - y0) / Dx;
-		min_i = min_x + min_y * Lx;
-		while(bb[min_i] == 0){
-			std::cout << "Nearest node type: " << bb[min_i] << std::endl;
+		min_i = min_x + (idx)min_y * Lx;
+		while(nodeType(types, min_i) == 0){
+			std::cout << "Nearest node type: " << nodeType(types, min_i) << std::endl;
 			min_i = min_i - 1;
 		}
 		std::cout << "Using the nearest submerged node at(x = " << x0 + Dx*min_x << ", y = " << y0 + Dx*min_y << ")." << std::endl;
@@ -64,6 +115,85 @@ void getTSIndex(int* TSind, prec* TSx, prec* TSy, prec x0, prec y0,
 	}
 }
 
+void initPatch(patchStruct* patch, std::string name, std::string scenario, std::string inputdir,
+	std::string outputdir, mainDStruct devi, cudaStruct devEx, prec Dx, prec x0, prec y0, prec Dt) {
+	int Lx, Ly;
+	prec Dxf, x0f, y0f;
+	patch->name = name;
+	readInput(&patch->host.b, &patch->host.w, &patch->host.node_types, scenario + "_" + name, inputdir,
+		&Lx, &Ly, &Dxf, &x0f, &y0f);
+
+	int ratio = int(Dx / Dxf + 0.5);
+	int ox = int((x0f - x0) / Dx + 0.5);
+	int oy = int((y0f - y0) / Dx + 0.5);
+	if (ratio < 2 || fabs(ratio * Dxf - Dx) > 1E-6 * Dx) {
+		std::cout << "Patch " << name << ": Dx must be the coarse Dx divided by an integer." << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	if (fabs(x0 + ox * Dx - x0f) > 1E-6 * Dx || fabs(y0 + oy * Dx - y0f) > 1E-6 * Dx) {
+		std::cout << "Patch " << name << ": origin must lie on a coarse node." << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	if ((Lx - 1) % ratio != 0 || (Ly - 1) % ratio != 0 || Lx <= 2 * ratio || Ly <= 2 * ratio ||
+		ox < 0 || oy < 0 || ox + (Lx - 1) / ratio >= devi.Lx || oy + (Ly - 1) / ratio >= devi.Ly) {
+		std::cout << "Patch " << name << ": edges must lie on coarse nodes inside the domain." << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	patch->ratio = ratio;
+	patch->ox = ox;
+	patch->oy = oy;
+
+	// Same e = Dx/Dt and viscosity on every level
+	prec tau = devEx.coll.tau;
+	prec tauf = 0.5 + ratio * (tau - 0.5);
+	patch->alphaC2F = (fabs(tau - 1) > 1E-12) ? (tauf - 1) / (ratio * (tau - 1)) : 0;
+	patch->alphaF2C = (fabs(tauf - 1) > 1E-12) ? ratio * (tau - 1) / (tauf - 1) : 0;
+
+	patch->outputdir = outputdir + "/" + name;
+	#if defined(_WIN32)  
+		_mkdir(patch->outputdir.c_str());
+	#else
+		mkdir(patch->outputdir.c_str(), 0733);
+	#endif
+	writeConf(Lx, Ly, tauf, Dxf, Dt / ratio, patch->outputdir);
+	writeOutput((size_t)Lx * Ly, 0, patch->host.w, patch->outputdir);
+	std::cout << "Patch " << name << ": " << Lx << "x" << Ly << " nodes, ratio " << ratio
+		<< ", origin at coarse node (" << ox << ", " << oy << ")." << std::endl;
+
+	size_t num_bytes_d = (size_t)Lx * Ly * sizeof(prec);
+	size_t num_bytes_i = (size_t)Lx * Ly * sizeof(int);
+	patch->devi = devi;
+	patch->devi.Lx = Lx;
+	patch->devi.Ly = Ly;
+	patch->devi.Ngrid = int(((size_t)Lx * Ly + devi.Nblocks - 1) / devi.Nblocks);
+	fieldMalloc((void**)&patch->devi.w, num_bytes_d, "w");
+	fieldMalloc((void**)&patch->devi.b, num_bytes_d, "b");
+	fieldMalloc((void**)&patch->devi.node_types, num_bytes_i, "node_types");
+	hipMemcpy(patch->devi.b, patch->host.b, num_bytes_d, hipMemcpyHostToDevice);
+	hipMemcpy(patch->devi.w, patch->host.w, num_bytes_d, hipMemcpyHostToDevice);
+	uploadTypes(patch->devi.node_types, patch->host.node_types, Lx, Ly, devi.Nblocks);
+
+	patch->devEx = devEx;
+	collSetTau(&patch->devEx.coll, tauf);
+	#if LAZY
+		patch->devEx.active = NULL;
+	#endif
+	fieldMalloc((void**)&patch->devEx.h, num_bytes_d, "h");
+	fieldMalloc((void**)&patch->devEx.f1, 9 * num_bytes_d, "f1", FIELD_HUGE);
+	fieldMalloc((void**)&patch->devEx.f2, 9 * num_bytes_d, "f2", FIELD_HUGE);
+	#if IN == 3
+		fieldMalloc((void**)&patch->devEx.Arr_tri, 9 * (size_t)Lx * Ly * sizeof(unsigned char), "Arr_tri");
+	#elif IN == 4
+		fieldMalloc((void**)&patch->devEx.SC_bin, (size_t)Lx * Ly * sizeof(unsigned char), "SC_bin");
+		fieldMalloc((void**)&patch->devEx.BB_bin, (size_t)Lx * Ly * sizeof(unsigned char), "BB_bin");
+	#elif IN == 5
+		fieldMalloc((void**)&patch->devEx.SCBB_bin, (size_t)Lx * Ly * sizeof(unsigned short), "SCBB_bin");
+	#endif
+	#if SLOPE
+		fieldMalloc((void**)&patch->devEx.slope, 8 * (size_t)Lx * Ly * sizeof(sprec), "slope");
+	#endif
+}
+
 int dirExists(const char *path) {
 	struct stat info;
 
@@ -80,14 +210,23 @@ int main(int argc, char* argv[]) {
 		std::cout << "Please specify arguments!" << std::endl;
 		exit(EXIT_FAILURE);
 	}
-	int time_array[3], Lx, Ly, NTS, Nblocks;
-	prec Dx, x0, y0, tau, g, Dt;
+	int time_array[3], Lx, Ly, NTS, Nblocks, autotune;
+	prec Dx, x0, y0, tau, g, Dt, activeTol = 1E-10;
+	// BGK unless the configuration asks for TRT or MRT; the MRT rates are
+	// those of Lallemand and Luo
+	collStruct coll;
+	coll.model = COLL_BGK;
+	coll.magic = 0.25;
+	coll.sE = 1.64;
+	coll.sEps = 1.54;
+	coll.sQ = 1.9;
 
 	std::string scenario;
 	std::string test;
 	std::string dir;
+	std::vector<std::string> patchNames;
 
-	readConf(dir, scenario, test, time_array, &tau, &g, &Dt, &Nblocks, argv[1]);
+	readConf(dir, scenario, test, time_array, &tau, &g, &Dt, &Nblocks, &autotune, patchNames, &activeTol, &coll, argv[1]);
 
 	test = scenario + "_" + test;
 	std::string outputdir = dir + "Outputs/outputs_";
@@ -98,7 +237,7 @@ int main(int argc, char* argv[]) {
 	int c = 1;
 	std::string cstr = "";
 	while (dirExists(outputdir_temp.c_str())) {
-		cstr = static_cast<std::ostringstream*>(&(std::ostringstream() << c))->str();
+		cstr = std::to_string(c);
 		outputdir_temp = outputdir + "_" + cstr;
 		c++;
 	}
@@ -119,19 +258,16 @@ int main(int argc, char* argv[]) {
 	prec *TSx, *TSy;
 	readTSloc(&TSx, &TSy, &NTS, scenario, inputdir);
 	int TTS = int(ceil((prec)time_array[0] / (prec)time_array[2]));
-	host.TSdata = new prec[TTS * NTS];
-	host.TSind = new int[NTS];
+	host.TSdata = (prec*)hostFieldAlloc("TSdata", (size_t)TTS * NTS * sizeof(prec));
+	host.TSind = (idx*)hostFieldAlloc("TSind", NTS * sizeof(idx));
 	getTSIndex(host.TSind, TSx, TSy, x0, y0, host.node_types, Lx, Ly, Dx, NTS);
 
-	uint num_bytes_d = Lx * Ly * sizeof(prec);
-	uint num_bytes_i = Lx * Ly * sizeof(int);
-	int Ngrid = int(ceil((prec)Lx * (prec)Ly / (prec)Nblocks));
-	int ex[9] = { 0, 1, 0,-1, 0, 1,-1,-1, 1 };
-	int ey[9] = { 0, 0, 1, 0,-1, 1, 1,-1,-1 };
+	size_t num_bytes_d = (size_t)Lx * Ly * sizeof(prec);
+	int Ngrid = int(((size_t)Lx * Ly + Nblocks - 1) / Nblocks);
 	prec e = Dx / Dt;
 
 	writeConf(Lx, Ly, tau, Dx, Dt, outputdir);
-	writeOutput(Lx*Ly, 0, host.w, outputdir);
+	writeOutput((size_t)Lx * Ly, 0, host.w, outputdir);
 
 	devi.Lx = Lx;
 	devi.Ly = Ly;
@@ -140,43 +276,111 @@ int main(int argc, char* argv[]) {
 	devi.Nblocks = Nblocks;
 	devi.Ngrid = Ngrid;
 
-	hipMalloc((void**)&devi.w, num_bytes_d); 
-	hipMalloc((void**)&devi.b, num_bytes_d);
-	hipMalloc((void**)&devi.node_types, num_bytes_i);
-	hipMalloc((void**)&devi.TSdata, TTS * NTS * sizeof(prec));
-	hipMalloc((void**)&devi.TSind, NTS * sizeof(int));
-
+	fieldMalloc((void**)&devi.w, num_bytes_d, "w"); 
+	fieldMalloc((void**)&devi.TSdata, (size_t)TTS * NTS * sizeof(prec), "TSdata");
+	fieldMalloc((void**)&devi.TSind, NTS * sizeof(idx), "TSind");
+	#if SPARSE || ORDER
+		// sparseInit or orderedInit fill their storage from the host arrays, only w stays dense
+		devi.b = NULL;
+		devi.node_types = NULL;
+	#else
+	size_t num_bytes_i = (size_t)Lx * Ly * sizeof(int);
+	fieldMalloc((void**)&devi.b, num_bytes_d, "b");
+	fieldMalloc((void**)&devi.node_types, num_bytes_i, "node_types");
 	hipMemcpy(devi.b, host.b, num_bytes_d, hipMemcpyHostToDevice);
+	uploadTypes(devi.node_types, host.node_types, Lx, Ly, Nblocks);
+	#endif
+
 	hipMemcpy(devi.w, host.w, num_bytes_d, hipMemcpyHostToDevice);
-	hipMemcpy(devi.node_types, host.node_types, num_bytes_i, hipMemcpyHostToDevice);
-	hipMemcpy(devi.TSind, host.TSind, NTS * sizeof(int), hipMemcpyHostToDevice);
+	hipMemcpy(devi.TSind, host.TSind, NTS * sizeof(idx), hipMemcpyHostToDevice);
 
-	devEx.tau = tau;
+	collSetTau(&coll, tau);
+	devEx.coll = coll;
+	if (coll.model == COLL_TRT)
+		std::cout << "Collision: TRT, magic parameter " << coll.magic << ", tau- " << coll.tauMinus << std::endl;
+	else if (coll.model == COLL_MRT)
+		std::cout << "Collision: MRT, rates " << coll.sE << " " << coll.sEps << " " << coll.sQ << std::endl;
 	devEx.g = g;
 	devEx.e = e;
-	hipMalloc((void**)&devEx.ex, 9 * sizeof(int));
-	hipMalloc((void**)&devEx.ey, 9 * sizeof(int));
-	hipMalloc((void**)&devEx.h, num_bytes_d);
-	hipMalloc((void**)&devEx.f1, 9 * num_bytes_d);
-	hipMalloc((void**)&devEx.f2, 9 * num_bytes_d);
+	devEx.activeTol = activeTol;
+	#if GHOST
+		// The frame is never written and stays zero
+		size_t ghost = ghostSize(Lx, Ly);
+		fieldMalloc((void**)&devEx.h, ghost * sizeof(prec), "h");
+		fieldMalloc((void**)&devEx.f1, 9 * ghost * sizeof(pop), "f1", FIELD_HUGE);
+		fieldMalloc((void**)&devEx.f2, 9 * ghost * sizeof(pop), "f2", FIELD_HUGE);
+		hipMemset(devEx.h, 0, ghost * sizeof(prec));
+		hipMemset(devEx.f1, 0, 9 * ghost * sizeof(pop));
+		hipMemset(devEx.f2, 0, 9 * ghost * sizeof(pop));
+	#elif OOC
+		fieldMalloc((void**)&devEx.h, num_bytes_d, "h");
+		fieldMalloc((void**)&devEx.f1, 9 * (size_t)Lx * Ly * sizeof(pop), "f1", FIELD_FILE);
+		fieldMalloc((void**)&devEx.f2, 9 * (size_t)Lx * Ly * sizeof(pop), "f2", FIELD_FILE);
+	#elif !SPARSE && !ORDER
+	fieldMalloc((void**)&devEx.h, num_bytes_d, "h");
+	fieldMalloc((void**)&devEx.f1, 9 * (size_t)Lx * Ly * sizeof(pop), "f1", FIELD_HUGE);
+	fieldMalloc((void**)&devEx.f2, 9 * (size_t)Lx * Ly * sizeof(pop), "f2", FIELD_HUGE);
+	#endif
 	#if IN == 3
-		hipMalloc((void**)&devEx.Arr_tri, 9 * Lx * Ly * sizeof(unsigned char));
-	#elif IN == 4
-		hipMalloc((void**)&devEx.SC_bin, Lx * Ly * sizeof(unsigned char));
-		hipMalloc((void**)&devEx.BB_bin, Lx * Ly * sizeof(unsigned char));
+		fieldMalloc((void**)&devEx.Arr_tri, 9 * (size_t)Lx * Ly * sizeof(unsigned char), "Arr_tri");
+	#elif IN == 4 && !SPARSE && !ORDER
+		fieldMalloc((void**)&devEx.SC_bin, (size_t)Lx * Ly * sizeof(unsigned char), "SC_bin");
+		fieldMalloc((void**)&devEx.BB_bin, (size_t)Lx * Ly * sizeof(unsigned char), "BB_bin");
+	#elif IN == 5
+		fieldMalloc((void**)&devEx.SCBB_bin, (size_t)Lx * Ly * sizeof(unsigned short), "SCBB_bin");
+	#endif
+	#if LAZY
+		int Ntiles = ((Lx + TILE - 1) / TILE) * ((Ly + TILE - 1) / TILE);
+		fieldMalloc((void**)&devEx.active, Ntiles * sizeof(unsigned char), "active");
+		fieldMalloc((void**)&devEx.h0, num_bytes_d, "h0");
 	#endif
+	#if POP16
+		int NT9 = 9 * ((Lx + TILE - 1) / TILE) * ((Ly + TILE - 1) / TILE);
+		fieldMalloc((void**)&devEx.s1, NT9 * sizeof(float), "s1");
+		fieldMalloc((void**)&devEx.s2, NT9 * sizeof(float), "s2");
+		fieldMalloc((void**)&devEx.popFlags, 2 * NT9 * sizeof(unsigned char), "popFlags");
+		fieldMalloc((void**)&devEx.wt, NT9 / 9 * sizeof(prec), "wt");
+	#endif
+	#if SLOPE
+		fieldMalloc((void**)&devEx.slope, 8 * (size_t)Lx * Ly * sizeof(sprec), "slope");
+	#endif
+
+	#if SPARSE
+		sparseInit(host, devi, &devEx);
+	#endif
+	#if ORDER
+		orderedInit(host, devi, &devEx);
+	#endif
+	#if SPLIT
+		splitInit(devi, &devEx);
+	#endif
+
+	// Patches inherit the tuned Nblocks
+	if (autotune != 0)
+		tuneLaunch(&devi, devEx, host.node_types, autotune == 2, dir + "tuning.txt");
+
+	int NP = patchNames.size();
+	#if SPARSE || ORDER || SPLIT || POP16 || GHOST || OOC
+		if (NP > 0) {
+			std::cout << "Refinement patches are not supported with SPARSE, ORDER, SPLIT, POP16, GHOST or OOC builds." << std::endl;
+			exit(EXIT_FAILURE);
+		}
+	#endif
+	patchStruct* patches = new patchStruct[NP];
+	for (int p = 0; p < NP; p++)
+		initPatch(&patches[p], patchNames[p], scenario, inputdir, outputdir, devi, devEx, Dx, x0, y0, Dt);
+
+	allocReport();
 
-	hipMemcpy(devEx.ex, ex, 9 * sizeof(int), hipMemcpyHostToDevice);
-	hipMemcpy(devEx.ey, ey, 9 * sizeof(int), hipMemcpyHostToDevice);
-	clock_t t1, t2; 
+	// Wall time: clock() would add up the CPU time of every host worker
 	std::cout << "\nStart\n";
-	t1 = clock();
-	LBM(host, devi, devEx, time_array, Dt, outputdir);
-	t2 = clock();
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	LBM(host, devi, devEx, patches, NP, time_array, Dt, outputdir);
+	prec elapsedTime = std::chrono::duration<prec, std::milli>(std::chrono::steady_clock::now() - t1).count();
 
-	std::cout << std::endl << "Tiempo total: " << 1000.0 * (prec)(t2 - t1) / CLOCKS_PER_SEC << "[ms]" << std::endl;
+	std::cout << std::endl << "Tiempo total: " << elapsedTime << "[ms]" << std::endl;
 
-	freemem(host, devi, devEx);
+	freemem(host, devi, devEx, patches, NP);
 	return 0;
 } 
 
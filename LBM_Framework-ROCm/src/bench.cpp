@@ -0,0 +1,373 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#include <hip/hip_runtime.h>
+#include "include/structs.h"
+#include "include/macros.h"
+#include "cpp/include/utils.h"
+#include "cu/include/LBM.cuh"
+#include "cu/include/utils.cuh"
+#include "cu/include/moments.cuh"
+
+// Benchmark driver: times the LBM step for every requested layout and grid
+// size on a synthetic basin, so no input files are needed. Each step and
+// kernel is placed on the roofline given by a STREAM triad measured at
+// start-up and the peak arithmetic rate of the device.
+//
+// usage: bin/bench [-s sizes] [-l layouts] [-ts steps] [-w warmup] [-r reps]
+//                  [-bs block_size] [-pf peak_gflops] [-f csv|json] [-o file]
+
+static const char* backend = "hip";
+
+typedef struct benchResult {
+	std::string layout;
+	int Lx;
+	int Ly;
+	int blockSize;
+	int steps;
+	int reps;
+	double median;
+	double min;
+	double stdev;
+	double mlups;
+	double gbs;
+	double gflops;
+	double kernelMs[3];
+} benchResult;
+
+static const char* kernelNames[3] = { "First", "Second", "Third" };
+
+// Global memory traffic per wet node of each kernel, each array counted once:
+//   First  reads binary1/2, f1 (9) and, for the SWE forcing, h and b (or
+//          the 8 stored slopes with SLOPE); writes forcing (8) and localf (9)
+//   Second reads binary1/2, localf (9); writes macro (3) and h
+//   Third  reads binary1/2, macro (3), localf (9); writes f2 (9)
+// With MOMENTS f1 and f2 hold NMOM values per node instead of 9.
+static double kernelBytes(int k) {
+	int pops = MOMENTS ? NMOM : 9;
+	int precs[3] = { pops + 8 + 9, 9 + 3 + 1, 3 + 9 + pops };
+	double slopes = 0;
+	#if PDE == 1
+		precs[0] += SLOPE ? 1 : 2;
+		slopes = (k == 0 && SLOPE) ? 8 * sizeof(sprec) : 0;
+	#endif
+	return 2 * sizeof(unsigned char) + precs[k] * sizeof(prec) + slopes;
+}
+
+// Floating point operations per wet node of each kernel, counted from the
+// source with divisions as one operation and compile-time constants folded:
+//   First  SWE forcing (5 per axis and 6 per diagonal direction, one less
+//          with stored slopes, 3 for the factor) and the 8 additions that
+//          apply it while streaming
+//   Second 8 additions for h and 7 operations for each velocity
+//   Third  the equilibrium and 3 per population for the BGK relaxation
+// With MOMENTS First also rebuilds the 9 populations (39 each: velocity 4,
+// equilibrium 22, non-equilibrium 13) and Third takes the moments of the
+// relaxed populations (242: 9 equilibria, 9 differences and 35 for the
+// sums), SWE counts used for the NSE too.
+// The wave equation and user defined equilibria are not modelled (0).
+static double kernelFlops(int k) {
+	#if PDE == 1
+		double flops[3] = { 4 * (5 - (SLOPE != 0)) + 4 * (6 - (SLOPE != 0)) + 3 + 8, 8 + 2 * 7, 89 + 9 * 3 };
+	#elif PDE == 2
+		double flops[3] = { 0, 8 + 2 * 7, 14 + 9 * 3 };
+	#elif PDE == 4
+		double flops[3] = { 0, 8 + 2 * 7, 80 + 9 * 3 };
+	#else
+		double flops[3] = { 0, 0, 0 };
+	#endif
+	#if MOMENTS
+		flops[0] += 9 * 39;
+		flops[2] += 242;
+	#endif
+	return flops[k];
+}
+
+static double stepBytes() {
+	return kernelBytes(0) + kernelBytes(1) + kernelBytes(2);
+}
+
+static double stepFlops() {
+	return kernelFlops(0) + kernelFlops(1) + kernelFlops(2);
+}
+
+__global__ void triadKernel(int n, prec* a, const prec* __restrict__ b, const prec* __restrict__ c, prec s) {
+	int i = threadIdx.x + blockIdx.x*blockDim.x;
+	if (i < n)
+		a[i] = b[i] + s * c[i];
+}
+
+// Sustained bandwidth in GB/s: best of 10 STREAM triads a = b + s*c over
+// arrays far larger than the device caches, counting 3 arrays per pass.
+static double streamTriad(int blockSize) {
+	const int n = 1 << 25;
+	const int reps = 10;
+	prec *a, *b, *c;
+	hipMalloc((void**)&a, n * sizeof(prec));
+	hipMalloc((void**)&b, n * sizeof(prec));
+	hipMalloc((void**)&c, n * sizeof(prec));
+	hipMemset(b, 0, n * sizeof(prec));
+	hipMemset(c, 0, n * sizeof(prec));
+	hipEvent_t ct1, ct2;
+	hipEventCreate(&ct1);
+	hipEventCreate(&ct2);
+	float dt, best = 0;
+	int grid = (n + blockSize - 1) / blockSize;
+	for (int r = 0; r <= reps; r++) {
+		hipEventRecord(ct1);
+		hipLaunchKernelGGL(triadKernel, dim3(grid), dim3(blockSize), 0, 0, n, a, b, c, (prec)3.0);
+		hipEventRecord(ct2);
+		hipEventSynchronize(ct2);
+		hipEventElapsedTime(&dt, ct1, ct2);
+		// the first pass only warms up
+		if (r == 1 || (r > 1 && dt < best))
+			best = dt;
+	}
+	hipEventDestroy(ct1);
+	hipEventDestroy(ct2);
+	hipFree(a);
+	hipFree(b);
+	hipFree(c);
+	return 3.0 * n * sizeof(prec) / (best * 1e6);
+}
+
+// Without -pf the peak is estimated as 64 lanes per compute unit retiring one
+// fused multiply-add per cycle; devices with reduced double precision rate
+// need the datasheet value.
+static double peakGflops(const hipDeviceProp_t& prop) {
+	return 2.0 * 64 * prop.multiProcessorCount * prop.clockRate * 1e-6;
+}
+
+// Flat basin 10 m deep with a 5 cm Gaussian hump a third of the way along x
+static void basin(configStruct *config, mainStruct *host, int L) {
+	config->Lx = L;
+	config->Ly = L;
+	config->dx = 100.0;
+	config->e = config->dx / config->dt;
+	config->gridSize = int(((size_t)config->Lx * config->Ly + config->blockSize - 1) / config->blockSize);
+	host->b = new prec[(size_t)L * L];
+	host->w = new prec[(size_t)L * L];
+	for (int y = 0; y < L; y++)
+		for (int x = 0; x < L; x++) {
+			prec r2 = (x - L / 3.0) * (x - L / 3.0) + (y - L / 2.0) * (y - L / 2.0);
+			host->b[x + (size_t)y * L] = -10.0;
+			host->w[x + (size_t)y * L] = 0.05 * exp(-r2 / (L * L / 100.0));
+		}
+}
+
+static std::vector<int> parseList(char* arg, std::string name, bool layouts) {
+	std::vector<int> values;
+	std::stringstream list(arg);
+	std::string item;
+	while (std::getline(list, item, ',')) {
+		if (layouts && item == "all") {
+			values.push_back(LAYOUT_AOS);
+			values.push_back(LAYOUT_SOA);
+			values.push_back(LAYOUT_AOSOA);
+		}
+		else if (layouts)
+			values.push_back(parseArgumentLayout(&item[0], name));
+		else
+			values.push_back(parseArgumentInt(&item[0], name));
+	}
+	return values;
+}
+
+static void benchUsage(std::string name) {
+	std::cerr << "Usage:\n\t" << name << " [-h] [-s sizes] [-l layouts] [-ts time_steps] [-w warmup] "
+			  << "[-r repetitions] [-bs block_size] [-pf peak_gflops] [-f format] [-o output_file]\n"
+			  << "Options: \n"
+			  << "\t-s, --sizes\n"
+			  << "\t\tComma separated grid sizes L of L x L basins. The default is 100,200,400,800,1600,3200\n"
+			  << "\t-l, --layout\n"
+			  << "\t\tComma separated layouts (aos, soa, aosoa) or all. The default is all\n"
+			  << "\t-ts, --time-steps\n"
+			  << "\t\tTime steps per repetition. The default is 100\n"
+			  << "\t-w, --warmup\n"
+			  << "\t\tUntimed time steps before the first repetition. The default is 20\n"
+			  << "\t-r, --repetitions\n"
+			  << "\t\tTimed repetitions per run. The default is 10\n"
+			  << "\t-bs, --block-size\n"
+			  << "\t\tNumber of threads per block. The default is 256\n"
+			  << "\t-pf, --peak-flops\n"
+			  << "\t\tPeak arithmetic rate of the device in GFLOP/s. The default is estimated from its properties\n"
+			  << "\t-f, --format\n"
+			  << "\t\tcsv or json. The default is csv\n"
+			  << "\t-o, --output\n"
+			  << "\t\tFile for the csv/json results. The default is the standard output" << std::endl;
+	exit(EXIT_FAILURE);
+}
+
+static void writeResults(std::ostream& out, std::string format, std::string device, double triad,
+						 double peak, const std::vector<benchResult>& results) {
+	out << std::setprecision(6);
+	if (format == "csv")
+		out << "backend,device,prec,layout,lx,ly,block_size,steps,reps,median_ms,min_ms,stdev_ms,mlups,gbs,"
+			<< "gflops,triad_gbs,peak_gflops,bw_pct,flops_pct,first_ms,second_ms,third_ms\n";
+	else
+		out << "[\n";
+	for (size_t k = 0; k < results.size(); k++) {
+		const benchResult& r = results[k];
+		if (format == "csv")
+			out << backend << "," << device << "," << PREC << "," << r.layout << "," << r.Lx << "," << r.Ly << ","
+				<< r.blockSize << "," << r.steps << "," << r.reps << "," << r.median << "," << r.min << ","
+				<< r.stdev << "," << r.mlups << "," << r.gbs << "," << r.gflops << "," << triad << "," << peak << ","
+				<< 100 * r.gbs / triad << "," << 100 * r.gflops / peak << "," << r.kernelMs[0] << ","
+				<< r.kernelMs[1] << "," << r.kernelMs[2] << "\n";
+		else
+			out << "  {\"backend\": \"" << backend << "\", \"device\": \"" << device << "\", \"prec\": " << PREC
+				<< ", \"layout\": \"" << r.layout << "\", \"lx\": " << r.Lx << ", \"ly\": " << r.Ly
+				<< ", \"block_size\": " << r.blockSize << ", \"steps\": " << r.steps << ", \"reps\": " << r.reps
+				<< ", \"median_ms\": " << r.median << ", \"min_ms\": " << r.min << ", \"stdev_ms\": " << r.stdev
+				<< ", \"mlups\": " << r.mlups << ", \"gbs\": " << r.gbs << ", \"gflops\": " << r.gflops
+				<< ", \"triad_gbs\": " << triad << ", \"peak_gflops\": " << peak
+				<< ", \"bw_pct\": " << 100 * r.gbs / triad << ", \"flops_pct\": " << 100 * r.gflops / peak
+				<< ", \"first_ms\": " << r.kernelMs[0] << ", \"second_ms\": " << r.kernelMs[1]
+				<< ", \"third_ms\": " << r.kernelMs[2] << "}"
+				<< ((k + 1 < results.size()) ? ",\n" : "\n");
+	}
+	if (format == "json")
+		out << "]\n";
+}
+
+int main(int argc, char* argv[]) {
+	char defaultSizes[] = "100,200,400,800,1600,3200";
+	char defaultLayouts[] = "all";
+	std::vector<int> sizes = parseList(defaultSizes, "--sizes", false);
+	std::vector<int> layouts = parseList(defaultLayouts, "--layout", true);
+	int steps = 100, warmup = 20, reps = 10, blockSize = 256;
+	double peak = 0;
+	std::string format = "csv", outputFile = "";
+	std::string arg;
+	for (int i = 1; i < argc; i++) {
+		arg = argv[i];
+		if (arg == "-h" || arg == "--help" || i + 1 == argc)
+			benchUsage(argv[0]);
+		else if (arg == "-s" || arg == "--sizes")
+			sizes = parseList(argv[++i], arg, false);
+		else if (arg == "-l" || arg == "--layout")
+			layouts = parseList(argv[++i], arg, true);
+		else if (arg == "-ts" || arg == "--time-steps")
+			steps = parseArgumentInt(argv[++i], arg);
+		else if (arg == "-w" || arg == "--warmup")
+			warmup = parseArgumentInt(argv[++i], arg);
+		else if (arg == "-r" || arg == "--repetitions")
+			reps = parseArgumentInt(argv[++i], arg);
+		else if (arg == "-bs" || arg == "--block-size")
+			blockSize = parseArgumentInt(argv[++i], arg);
+		else if (arg == "-pf" || arg == "--peak-flops")
+			peak = parseArgumentPrec(argv[++i], arg);
+		else if (arg == "-f" || arg == "--format")
+			format = argv[++i];
+		else if (arg == "-o" || arg == "--output")
+			outputFile = argv[++i];
+		else
+			benchUsage(argv[0]);
+	}
+	if (steps < 1 || warmup < 0 || reps < 1 || blockSize < 1 || (format != "csv" && format != "json")) {
+		std::cerr << "Invalid benchmark options" << std::endl;
+		benchUsage(argv[0]);
+	}
+
+	hipDeviceProp_t prop;
+	hipGetDeviceProperties(&prop, 0);
+	std::string device = prop.name;
+
+	double triad = streamTriad(blockSize);
+	bool estimated = (peak == 0);
+	if (estimated)
+		peak = peakGflops(prop);
+
+	std::cout << "Backend " << backend << " on " << device << ", " << PREC << "-bit, ";
+	if (SLOPE)
+		std::cout << SLOPE << "-bit stored slopes, ";
+	if (MOMENTS)
+		std::cout << "moment storage, ";
+	std::cout << stepBytes() << " bytes and " << stepFlops() << " flops per node and step" << std::endl;
+	std::cout << std::fixed << std::setprecision(1) << "Roofline: triad " << triad << " GB/s, peak " << peak
+			  << " GFLOP/s" << (estimated ? " (estimated, set -pf)" : "") << ", ridge at "
+			  << std::setprecision(2) << peak / triad << " flop/B" << std::endl;
+	std::cout << std::setw(6) << "layout" << std::setw(7) << "L" << std::setw(12) << "median[ms]"
+			  << std::setw(10) << "min[ms]" << std::setw(10) << "stdev[%]" << std::setw(9) << "MLUPS"
+			  << std::setw(8) << "GB/s" << std::setw(7) << "%BW" << std::setw(9) << "GFLOP/s"
+			  << std::setw(7) << "%peak" << std::endl;
+	std::vector<benchResult> results;
+	std::vector<double> samples(reps);
+	double kernelMs[3];
+	for (size_t l = 0; l < layouts.size(); l++)
+		for (size_t s = 0; s < sizes.size(); s++) {
+			configStruct config;
+			mainStruct host, device;
+			cudaStruct deviceOnly;
+			config.test = "bench";
+			config.timeMax = steps;
+			config.dtOut = 0;
+			config.blockSize = blockSize;
+			config.dt = 2.0;
+			config.tau = 0.8;
+			config.collision = COLL_BGK;
+			config.layout = layouts[l];
+			basin(&config, &host, sizes[s]);
+			memoryInit(config, &deviceOnly, &device, host);
+			LBMbench(config, device, &deviceOnly, warmup, reps, steps, &samples[0], kernelMs);
+			memoryFree(host, device, deviceOnly);
+
+			std::vector<double> sorted(samples);
+			std::sort(sorted.begin(), sorted.end());
+			double mean = 0, var = 0;
+			for (int r = 0; r < reps; r++)
+				mean += samples[r] / reps;
+			for (int r = 0; r < reps; r++)
+				var += (samples[r] - mean) * (samples[r] - mean) / std::max(reps - 1, 1);
+
+			benchResult res;
+			res.layout = layoutName(config.layout);
+			res.Lx = config.Lx;
+			res.Ly = config.Ly;
+			res.blockSize = blockSize;
+			res.steps = steps;
+			res.reps = reps;
+			res.median = (reps % 2 == 1) ? sorted[reps / 2] : 0.5 * (sorted[reps / 2 - 1] + sorted[reps / 2]);
+			res.min = sorted[0];
+			res.stdev = sqrt(var);
+			res.mlups = (double)config.Lx * config.Ly / (res.median * 1e3);
+			res.gbs = res.mlups * stepBytes() * 1e-3;
+			res.gflops = res.mlups * stepFlops() * 1e-3;
+			for (int k = 0; k < 3; k++)
+				res.kernelMs[k] = kernelMs[k];
+			results.push_back(res);
+
+			std::cout << std::fixed << std::setw(6) << res.layout << std::setw(7) << sizes[s]
+					  << std::setprecision(4) << std::setw(12) << res.median << std::setw(10) << res.min
+					  << std::setprecision(1) << std::setw(10) << 100 * res.stdev / res.median
+					  << std::setw(9) << res.mlups << std::setw(8) << res.gbs << std::setw(7) << 100 * res.gbs / triad
+					  << std::setw(9) << res.gflops << std::setw(7) << 100 * res.gflops / peak << std::endl;
+			for (int k = 0; k < 3; k++) {
+				double nodes = (double)config.Lx * config.Ly / (kernelMs[k] * 1e6);
+				std::cout << std::setw(13) << kernelNames[k] << std::setprecision(4) << std::setw(12) << kernelMs[k]
+						  << std::setw(37) << std::setprecision(1) << nodes * kernelBytes(k)
+						  << std::setw(7) << 100 * nodes * kernelBytes(k) / triad << std::setw(9)
+						  << nodes * kernelFlops(k) << std::setw(7) << 100 * nodes * kernelFlops(k) / peak << std::endl;
+			}
+		}
+
+	if (outputFile == "") {
+		writeResults(std::cout, format, device, triad, peak, results);
+	}
+	else {
+		std::ofstream out(outputFile.c_str());
+		if (!out.is_open()) {
+			std::cerr << "Can't create output file " << outputFile << std::endl;
+			exit(EXIT_FAILURE);
+		}
+		writeResults(out, format, device, triad, peak, results);
+		std::cout << "Results written to " << outputFile << std::endl;
+	}
+	return 0;
+}
@@ -20,8 +20,15 @@ void setConfig(configStruct *config, char* argv[], int argc){
 	config->timeMax = 1000;
 	config->dtOut = 0;
 	config->blockSize = 256;
+	config->autotune = 0;
 	config->dt = 2.0;
 	config->tau = 0.8;
+	config->layout = LAYOUT_SOA;
+	config->collision = COLL_BGK;
+	config->magic = 0.25;
+	config->sE = 1.64;
+	config->sEps = 1.54;
+	config->sQ = 1.9;
 	if (config->test == "-h" || config->test == "--help")
 		showUsage("o", argv[0]);		
 	for (int i = 1; i < argc-2; i++){
@@ -37,12 +44,25 @@ void setConfig(configStruct *config, char* argv[], int argc){
 		else if (arg == "-do" || arg == "--delta-out")
 			config->dtOut = parseArgumentInt(argv[i+1], arg);
 		else if (arg == "-bs" || arg == "--block-size")
-			config->blockSize = parseArgumentInt(argv[i+1], arg);
+			config->blockSize = parseArgumentBlockSize(argv[i+1], arg, &config->autotune);
 		else if (arg == "-dt" || arg == "--delta-time")
 			config->dt = parseArgumentPrec(argv[i+1], arg);
 		else if (arg == "-t" || arg == "--tau")
 			config->tau = parseArgumentPrec(argv[i+1], arg);
+		else if (arg == "-l" || arg == "--layout")
+			config->layout = parseArgumentLayout(argv[i+1], arg);
+		else if (arg == "-c" || arg == "--collision")
+			config->collision = parseArgumentCollision(argv[i+1], arg);
+		else if (arg == "-m" || arg == "--magic")
+			config->magic = parseArgumentPrec(argv[i+1], arg);
+		else if (arg == "-se" || arg == "--rate-e")
+			config->sE = parseArgumentPrec(argv[i+1], arg);
+		else if (arg == "-seps" || arg == "--rate-eps")
+			config->sEps = parseArgumentPrec(argv[i+1], arg);
+		else if (arg == "-sq" || arg == "--rate-q")
+			config->sQ = parseArgumentPrec(argv[i+1], arg);
 	}
+	config->tauMinus = 0.5 + config->magic / (config->tau - 0.5);
 	config->inputFile = config->inputPath + config->test + ".txt";
 	verifyDir("Input", config->inputPath);
 	verifyDir("Output", config->outputPath);
@@ -59,6 +79,7 @@ void writeConfig(configStruct config){
 	myfile << "TEST       " << config.test << "\n" 
 		   << "OUTPUT_DIR " << config.outputDir << "\n"  
 		   << "INPUT_FILE " << config.inputFile << "\n" 
+		   << "LAYOUT     " << layoutName(config.layout) << "\n" 
 		   << "BLOCK_SIZE " << config.blockSize << "\n" 
 		   << "GRID_SIZE  " << config.gridSize << "\n" 
 		   << "LX         " << config.Lx << "\n" 
@@ -67,7 +88,12 @@ void writeConfig(configStruct config){
 		   << "DT         " << config.dt << "\n"
 		   << "TIME_STEPS " << config.timeMax << "\n"
 		   << "D_OUTPUT   " << config.dtOut << "\n"  
-		   << "TAU        " << config.tau 
+		   << "TAU        " << config.tau << "\n"
+		   << "COLLISION  " << collisionName(config.collision) << "\n"
+		   << "MAGIC      " << config.magic << "\n"
+		   << "RATE_E     " << config.sE << "\n"
+		   << "RATE_EPS   " << config.sEps << "\n"
+		   << "RATE_Q     " << config.sQ
 		   << std::endl;
 	myfile.close();
 }	
\ No newline at end of file
@@ -19,12 +19,13 @@ void readInput(configStruct *config, mainStruct *main) {
 	fscanf(fp, "%d %d %lf\n", &(config->Lx), &(config->Ly), &dxTemp);
 	config->dx = (prec)dxTemp;
 	config->e = config->dx/config->dt;
-	config->gridSize = int(ceil((prec)config->Lx * config->Ly / config->blockSize));
+	config->gridSize = int(((size_t)config->Lx * config->Ly + config->blockSize - 1) / config->blockSize);
 
-	main->b = new prec[config->Lx*config->Ly];
-	main->w = new prec[config->Lx*config->Ly];
+	size_t nodes = (size_t)config->Lx * config->Ly;
+	main->b = new prec[nodes];
+	main->w = new prec[nodes];
 	double wTemp, bTemp;
-	for (int i = 0; i < config->Lx*config->Ly; i++){
+	for (size_t i = 0; i < nodes; i++){
 		fscanf(fp, "%lf %lf\n", &wTemp, &bTemp);
 		main->w[i] = wTemp;
 		main->b[i] = bTemp;
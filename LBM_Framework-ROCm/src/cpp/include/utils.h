@@ -10,6 +10,16 @@
 
 	int parseArgumentInt(char*, std::string);
 
+	int parseArgumentBlockSize(char*, std::string, int*);
+
+	int parseArgumentLayout(char*, std::string);
+
+	std::string layoutName(int);
+
+	int parseArgumentCollision(char*, std::string);
+
+	std::string collisionName(int);
+
 	void verifyDir(std::string, std::string);
 
 	void verifyFile(std::string, std::string);
@@ -5,8 +5,10 @@
 #include "include/input.h"
 #include "../include/structs.h"
 #include "../include/macros.h"
+#include "../include/trace.h"
 
 void readInput(configStruct *config, mainStruct *main) {
+	TRACE_ZONE("read input");
 	FILE *fp;
 	fp = fopen(config->inputFile.c_str(), "r");
 	std::cout << "Reading input from " << config->inputFile << std::endl;
@@ -15,12 +17,13 @@ void readInput(configStruct *config, mainStruct *main) {
 	fscanf(fp, "%d %d %lf\n", &(config->Lx), &(config->Ly), &dxTemp);
 	config->dx = (prec)dxTemp;
 	config->e = config->dx/config->dt;
-	config->gridSize = int(ceil((prec)config->Lx * config->Ly / config->blockSize));
+	config->gridSize = int(((size_t)config->Lx * config->Ly + config->blockSize - 1) / config->blockSize);
 
-	main->b = new prec[config->Lx*config->Ly];
-	main->w = new prec[config->Lx*config->Ly];
+	size_t nodes = (size_t)config->Lx * config->Ly;
+	main->b = new prec[nodes];
+	main->w = new prec[nodes];
 	double wTemp, bTemp;
-	for (int i = 0; i < config->Lx*config->Ly; i++){
+	for (size_t i = 0; i < nodes; i++){
 		fscanf(fp, "%lf %lf\n", &bTemp, &wTemp);
 		main->w[i] = wTemp;
 		main->b[i] = bTemp;
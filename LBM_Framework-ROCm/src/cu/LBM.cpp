@@ -0,0 +1,198 @@
+#include "hip/hip_runtime.h"
+#include <iostream>
+#include <iomanip>
+#include <hip/hip_runtime.h>
+#include "include/setup.cuh"
+#include "include/LBMkernels.cuh"
+#include "include/SWE.cuh"
+#include "include/utils.cuh"
+#include "include/layout.cuh"
+#include "../cpp/include/input.h"
+#include "../cpp/include/output.h"
+#include "../cpp/include/config.h"
+#include "../include/structs.h"
+#include "../include/macros.h"
+#include "../include/trace.h"
+
+void checkLaunch(const char* kernel) {
+	hipError_t err = hipGetLastError();
+	if (err != hipSuccess)
+		printf("CUDA Error in %s: %s\n", kernel, hipGetErrorString(err));
+}
+
+#if SLOPE
+	#define SLOPE_ARG deviceOnly->slope
+#else
+	#define SLOPE_ARG (sprec*)NULL
+#endif
+
+// Launches the three kernels of one time step without waiting for them. If
+// marks is given, events are recorded before each kernel and after the last.
+template <class L>
+void timeStep(configStruct config, mainStruct device, cudaStruct *deviceOnly, hipEvent_t *marks = NULL) {
+	if (marks != NULL)
+		hipEventRecord(marks[0]);
+	TRACE_KERNEL_BEGIN("First");
+	hipLaunchKernelGGL(First<L>, dim3(config.gridSize), dim3(config.blockSize), 0, 0, config, deviceOnly->macro, deviceOnly->forcing, deviceOnly->localf, device.b, SLOPE_ARG, deviceOnly->binary1, 
+								deviceOnly->binary2, deviceOnly->f1, deviceOnly->f2, deviceOnly->h);
+	TRACE_KERNEL_END();
+	checkLaunch("First");
+	if (marks != NULL)
+		hipEventRecord(marks[1]);
+
+	TRACE_KERNEL_BEGIN("Second");
+	hipLaunchKernelGGL(Second, dim3(config.gridSize), dim3(config.blockSize), 0, 0, config, deviceOnly->macro, deviceOnly->forcing, deviceOnly->localf, device.b, deviceOnly->binary1, 
+								deviceOnly->binary2, deviceOnly->f1, deviceOnly->f2, deviceOnly->h);
+	TRACE_KERNEL_END();
+	checkLaunch("Second");
+	if (marks != NULL)
+		hipEventRecord(marks[2]);
+
+	TRACE_KERNEL_BEGIN("Third");
+	hipLaunchKernelGGL(Third<L>, dim3(config.gridSize), dim3(config.blockSize), 0, 0, config, deviceOnly->macro, deviceOnly->forcing, deviceOnly->localf, device.b, deviceOnly->binary1, 
+								deviceOnly->binary2, deviceOnly->f1, deviceOnly->f2, deviceOnly->h);
+	TRACE_KERNEL_END();
+	checkLaunch("Third");
+	if (marks != NULL)
+		hipEventRecord(marks[3]);
+
+	pointerSwap(deviceOnly);
+}
+
+template <class L>
+void setup(configStruct config, mainStruct device, cudaStruct deviceOnly) {
+	TRACE_ZONE("setup");
+	TRACE_KERNEL_BEGIN("binaryKernel");
+	hipLaunchKernelGGL(binaryKernel, dim3(config.gridSize), dim3(config.blockSize), 0, 0, config, deviceOnly.binary1, deviceOnly.binary2);
+	TRACE_KERNEL_END();
+	TRACE_KERNEL_BEGIN("hKernel");
+	hipLaunchKernelGGL(hKernel, dim3(config.gridSize), dim3(config.blockSize), 0, 0, config, device.w, device.b, deviceOnly.h);
+	TRACE_KERNEL_END();
+	#if SLOPE
+		TRACE_KERNEL_BEGIN("slopeKernel");
+		hipLaunchKernelGGL(slopeKernel, dim3(config.gridSize), dim3(config.blockSize), 0, 0, config, device.b, deviceOnly.slope);
+		TRACE_KERNEL_END();
+	#endif
+	TRACE_KERNEL_BEGIN("fKernel");
+	hipLaunchKernelGGL(fKernel<L>, dim3(config.gridSize), dim3(config.blockSize), 0, 0, config, deviceOnly.h, deviceOnly.f1);
+	TRACE_KERNEL_END();
+}
+
+void copyAndWriteResultData(configStruct config, mainStruct host, mainStruct device, cudaStruct deviceOnly, int t){
+	TRACE_ZONE("sample");
+	TRACE_KERNEL_BEGIN("wKernel");
+	hipLaunchKernelGGL(wKernel, dim3(config.gridSize), dim3(config.blockSize), 0, 0, config, deviceOnly.h, device.b, device.w);
+	TRACE_KERNEL_END();
+	size_t pBytes = (size_t)config.Lx * config.Ly * sizeof(prec);
+	{
+		TRACE_ZONE("copy w");
+		hipMemcpy(host.w, device.w, pBytes, hipMemcpyDeviceToHost);
+	}
+	writeOutput(config, t, host.w);
+}
+
+// Step time is taken with events between outputs, so the loop only waits
+// for the device where an output copy would wait anyway.
+template <class L>
+void LBMloop(configStruct config, mainStruct host, mainStruct device, cudaStruct *deviceOnly) {
+	setup<L>(config, device, *deviceOnly);
+
+	int t = 0;
+	hipEvent_t ct1, ct2;
+	hipEventCreate(&ct1);
+	hipEventCreate(&ct2);
+	prec msecs = 0;
+
+	std::cerr << std::fixed << std::setprecision(1);
+	float dt;
+	TRACE_ZONE("LBM loop");
+	hipEventRecord(ct1);
+	while (t <= config.timeMax) {
+		t++;
+		timeStep<L>(config, device, deviceOnly);
+		if (config.dtOut != 0 && t%config.dtOut == 0) {
+			hipEventRecord(ct2);
+			hipEventSynchronize(ct2);
+			hipEventElapsedTime(&dt, ct1, ct2);
+			msecs += dt;
+			std::cout << "Time step: " << t << " (" << 100.0*t / config.timeMax << "%)" << std::endl;
+			copyAndWriteResultData(config, host, device, *deviceOnly, t);
+			hipEventRecord(ct1);
+		}
+	}
+	hipEventRecord(ct2);
+	hipEventSynchronize(ct2);
+	hipEventElapsedTime(&dt, ct1, ct2);
+	msecs += dt;
+	hipEventDestroy(ct1);
+	hipEventDestroy(ct2);
+
+	if (config.dtOut == 0) 
+		copyAndWriteResultData(config, host, device, *deviceOnly, t);
+	std::cout << "Average time per time step: " << msecs / config.timeMax << "[ms]" << std::endl;
+}
+
+// Runs warmup steps and then reps batches of steps time steps each, storing
+// the mean time per step of every batch in samples[0..reps-1] (milliseconds).
+// A last batch with events between the kernels stores the mean time of
+// First, Second and Third in kernelMs[0..2]; it is kept out of samples
+// since it waits for the device after every step.
+template <class L>
+void benchLoop(configStruct config, mainStruct device, cudaStruct *deviceOnly,
+			   int warmup, int reps, int steps, double *samples, double *kernelMs) {
+	setup<L>(config, device, *deviceOnly);
+	TRACE_ZONE("bench loop");
+	for (int t = 0; t < warmup; t++)
+		timeStep<L>(config, device, deviceOnly);
+
+	hipEvent_t ct1, ct2;
+	hipEventCreate(&ct1);
+	hipEventCreate(&ct2);
+	float dt;
+	for (int r = 0; r < reps; r++) {
+		hipEventRecord(ct1);
+		for (int t = 0; t < steps; t++)
+			timeStep<L>(config, device, deviceOnly);
+		hipEventRecord(ct2);
+		hipEventSynchronize(ct2);
+		hipEventElapsedTime(&dt, ct1, ct2);
+		samples[r] = dt / steps;
+	}
+
+	hipEvent_t marks[4];
+	for (int k = 0; k < 4; k++)
+		hipEventCreate(&marks[k]);
+	for (int k = 0; k < 3; k++)
+		kernelMs[k] = 0;
+	for (int t = 0; t < steps; t++) {
+		timeStep<L>(config, device, deviceOnly, marks);
+		hipEventSynchronize(marks[3]);
+		for (int k = 0; k < 3; k++) {
+			hipEventElapsedTime(&dt, marks[k], marks[k + 1]);
+			kernelMs[k] += dt / steps;
+		}
+	}
+	for (int k = 0; k < 4; k++)
+		hipEventDestroy(marks[k]);
+	hipEventDestroy(ct1);
+	hipEventDestroy(ct2);
+}
+
+void LBMbench(configStruct config, mainStruct device, cudaStruct *deviceOnly,
+			  int warmup, int reps, int steps, double *samples, double *kernelMs) {
+	if (config.layout == LAYOUT_AOS)
+		benchLoop<AoS>(config, device, deviceOnly, warmup, reps, steps, samples, kernelMs);
+	else if (config.layout == LAYOUT_AOSOA)
+		benchLoop<AoSoA>(config, device, deviceOnly, warmup, reps, steps, samples, kernelMs);
+	else
+		benchLoop<SoA>(config, device, deviceOnly, warmup, reps, steps, samples, kernelMs);
+}
+
+void LBM(configStruct config, mainStruct host, mainStruct device, cudaStruct *deviceOnly) {
+	if (config.layout == LAYOUT_AOS)
+		LBMloop<AoS>(config, host, device, deviceOnly);
+	else if (config.layout == LAYOUT_AOSOA)
+		LBMloop<AoSoA>(config, host, device, deviceOnly);
+	else
+		LBMloop<SoA>(config, host, device, deviceOnly);
+}
@@ -5,4 +5,6 @@
 
 	void LBM(configStruct, mainStruct, mainStruct, cudaStruct*);
 
+	void LBMbench(configStruct, mainStruct, cudaStruct*, int, int, int, double*, double*);
+
 #endif
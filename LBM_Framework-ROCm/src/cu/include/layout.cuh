@@ -0,0 +1,31 @@
+#ifndef LAYOUT_CUH
+	#define LAYOUT_CUH
+
+	#include "../../include/macros.h"
+
+	// Population addressing policies. Every kernel and boundary function that
+	// reads or writes f1/f2 is a template over one of these, and LBM() picks
+	// the instantiation from config.layout.
+
+	// the 9 populations of a node are contiguous
+	struct AoS {
+		__host__ __device__ static idx IDXcm(idx i, int j, int Lx, int Ly){
+			return 9*i + j;
+		}
+	};
+
+	// population j of all nodes is contiguous
+	struct SoA {
+		__host__ __device__ static idx IDXcm(idx i, int j, int Lx, int Ly){
+			return i + j * (idx)Lx * Ly;
+		}
+	};
+
+	// blocks of VLEN nodes, stored as 9 runs of VLEN values
+	struct AoSoA {
+		__host__ __device__ static idx IDXcm(idx i, int j, int Lx, int Ly){
+			return (i / VLEN) * 9 * VLEN + j * VLEN + i % VLEN;
+		}
+	};
+
+#endif
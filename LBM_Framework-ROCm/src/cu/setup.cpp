@@ -4,18 +4,20 @@
 #include "include/utils.cuh"
 #include "include/SWE.cuh"
 #include "include/PDEfeq.cuh"
+#include "include/layout.cuh"
+#include "include/moments.cuh"
 #include "../include/structs.h"
 #include "../include/macros.h"
 
 __global__ void binaryKernel(const configStruct config, 
 	unsigned char* binary1, unsigned char* binary2) {
 
-	int i = threadIdx.x + blockIdx.x*blockDim.x;
-	if (i < config.Lx*config.Ly) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)config.Lx*config.Ly) {
 		unsigned char b1;
 		unsigned char b2;
-		int y = (int)i / config.Lx;
-		int x = i - y * config.Lx;
+		int y = i / config.Lx;
+		int x = i - (idx)y * config.Lx;
 		if (y == 0) {
 			if (x == 0){
 				b1 = 4 + 8 + 64;
@@ -86,11 +88,12 @@ __device__ void calculateFeqSWE(prec* feq, prec* localMacroscopic, prec e){
 	feq[8] = localh * factor * 0.25 * (gh - uxuy6 + 4.5 * uxuy6*uxuy6 * factor - usq);
 }
 
+template <class L>
 __global__ void fKernel(const configStruct config,
 	const prec* __restrict__ h, prec* f) {
 
-	int i = threadIdx.x + blockIdx.x*blockDim.x;
-	if (i < config.Lx*config.Ly) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)config.Lx*config.Ly) {
 		prec feq[9];
 		prec localMacroscopic[] = {h[i], 0, 0};
 		#if PDE == 1
@@ -104,8 +107,12 @@ __global__ void fKernel(const configStruct config,
 		#elif PDE == 5
 			calculateFeqUser(feq, localMacroscopic, config.e);
 		#endif
-		for (int j = 0; j < 9; j++)
-			f[IDXcm(i, j, config.Lx, config.Ly)] = feq[j];
+		#if MOMENTS
+			storeMoments(f, feq, i, (idx)config.Lx*config.Ly, config.e);
+		#else
+			for (int j = 0; j < 9; j++)
+				f[L::IDXcm(i, j, config.Lx, config.Ly)] = feq[j];
+		#endif
 	}
 }
 
@@ -124,6 +131,6 @@ __device__ void calculateFeqHE(prec* feq, prec* localMacroscopic, prec e){
 	feq[8] = localT * factor * 0.25;
 }
 
-__device__ int IDXcm(int i, int j, int Lx, int Ly){
-	return i + j * Lx * Ly;
-}
+template __global__ void fKernel<AoS>(const configStruct, const prec* __restrict__, prec*);
+template __global__ void fKernel<SoA>(const configStruct, const prec* __restrict__, prec*);
+template __global__ void fKernel<AoSoA>(const configStruct, const prec* __restrict__, prec*);
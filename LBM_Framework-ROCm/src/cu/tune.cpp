@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <math.h>
+#include <stdlib.h>
+#include <hip/hip_runtime.h>
+#include "include/tune.cuh"
+#include "include/LBM.cuh"
+#include "../cpp/include/utils.h"
+#include "../include/structs.h"
+#include "../include/macros.h"
+
+#if !defined(_WIN32)
+	#include <unistd.h>
+#endif
+
+// The block size is chosen by timing a few steps of the actual grid for
+// every candidate. Results are appended to <output_path>/tuning.txt, one line
+// per machine, build variant and grid size, and the last matching line is
+// reused by later runs with -bs auto.
+
+typedef struct tuneEntry {
+	std::string machine;
+	std::string variant;
+	int Lx;
+	int Ly;
+	int blockSize;
+	double mlups;
+} tuneEntry;
+
+static std::string machineName() {
+	#if defined(_WIN32)
+		const char* host = getenv("COMPUTERNAME");
+		std::string name = (host != NULL) ? host : "unknown";
+	#else
+		char host[256] = "unknown";
+		gethostname(host, sizeof(host));
+		std::string name = host;
+	#endif
+	hipDeviceProp_t prop;
+	hipGetDeviceProperties(&prop, 0);
+	name = name + "/" + prop.name;
+	std::replace(name.begin(), name.end(), ' ', '_');
+	return name;
+}
+
+static std::string variantName(int layout) {
+	std::ostringstream name;
+	name << layoutName(layout) << "-PREC" << PREC << "-PDE" << PDE << "-BC" << BC1 << BC2 << "-VLEN" << VLEN << "-SLOPE" << SLOPE << "-MOM" << MOMENTS;
+	return name.str();
+}
+
+static bool readCache(std::string file, const tuneEntry& key, tuneEntry* found) {
+	std::ifstream cache(file.c_str());
+	tuneEntry e;
+	bool hit = false;
+	while (cache >> e.machine >> e.variant >> e.Lx >> e.Ly >> e.blockSize >> e.mlups)
+		if (e.machine == key.machine && e.variant == key.variant && e.Lx == key.Lx && e.Ly == key.Ly) {
+			*found = e;
+			hit = true;
+		}
+	return hit;
+}
+
+void tuneBlockSize(configStruct* config, mainStruct device, cudaStruct* deviceOnly) {
+	std::string file = config->outputPath + "tuning.txt";
+	double size = (double)config->Lx * config->Ly;
+	tuneEntry best;
+	best.machine = machineName();
+	best.variant = variantName(config->layout);
+	best.Lx = config->Lx;
+	best.Ly = config->Ly;
+	if (config->autotune == 2 || !readCache(file, best, &best)) {
+		int blocks[5] = { 64, 128, 256, 512, 1024 };
+		// About 10^8 node updates per candidate, at least 5 steps
+		int steps = std::max(5, std::min(100, (int)(1e8 / size)));
+		double ms, kernelMs[3];
+		std::cout << "Autotune: " << steps << " steps per block size" << std::endl;
+		best.mlups = 0;
+		for (int k = 0; k < 5; k++) {
+			config->blockSize = blocks[k];
+			config->gridSize = int(((size_t)size + blocks[k] - 1) / blocks[k]);
+			LBMbench(*config, device, deviceOnly, 2, 1, steps, &ms, kernelMs);
+			double mlups = size / (ms * 1e3);
+			if (mlups > best.mlups) {
+				best.mlups = mlups;
+				best.blockSize = blocks[k];
+			}
+		}
+
+		std::ofstream cache(file.c_str(), std::ios::app);
+		if (cache.is_open())
+			cache << best.machine << " " << best.variant << " " << best.Lx << " " << best.Ly
+				  << " " << best.blockSize << " " << best.mlups << "\n";
+		else
+			std::cerr << "Can't write tuning cache " << file << std::endl;
+		std::cout << "Autotune: tuned " << best.machine << " " << best.variant << ", saved to " << file << std::endl;
+	}
+	else
+		std::cout << "Autotune: cached in " << file << std::endl;
+
+	config->blockSize = best.blockSize;
+	config->gridSize = int(((size_t)size + best.blockSize - 1) / best.blockSize);
+	std::cout << std::fixed << std::setprecision(1) << "Autotune: block size " << best.blockSize
+			  << " (" << best.mlups << " MLUPS)" << std::endl;
+}
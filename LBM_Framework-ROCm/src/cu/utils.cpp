@@ -1,15 +1,9 @@
 #include <hip/hip_runtime.h>
 #include "include/utils.cuh"
+#include "include/moments.cuh"
 #include "../include/structs.h"
 #include "../include/macros.h"
-
-__device__ int IDX(int i, int j, int Lx, int* ex, int* ey){
-	return i + ex[j] + ey[j] * Lx;
-}
-
-__device__ int IDXcm(int i, int j){
-	return 9*i + j;
-}
+#include "../include/trace.h"
 
 void pointerSwap(cudaStruct *deviceOnly){
 	prec *tempPtr = deviceOnly->f1;
@@ -29,13 +23,26 @@ void memoryFree(mainStruct host, mainStruct device, cudaStruct deviceOnly){
 	hipFree(deviceOnly.f2);
 	hipFree(deviceOnly.binary1);
 	hipFree(deviceOnly.binary2);
+	hipFree(deviceOnly.localf);
+	hipFree(deviceOnly.forcing);
+	hipFree(deviceOnly.macro);
+	#if SLOPE
+		hipFree(deviceOnly.slope);
+	#endif
 }
 
 void memoryInit(configStruct config, cudaStruct *deviceOnly,
 		 		mainStruct *device, mainStruct host){
-	uint pBytes = config.Lx * config.Ly * sizeof(prec);
-	//uint iBytes = config.Lx * config.Ly * sizeof(int);
-	uint uBytes = config.Lx * config.Ly * sizeof(unsigned char);
+	TRACE_ZONE("memoryInit");
+	size_t nodes = (size_t)config.Lx * config.Ly;
+	size_t pBytes = nodes * sizeof(prec);
+	#if MOMENTS
+		size_t fBytes = NMOM * pBytes;
+	#else
+		// padded to whole AoSoA blocks so any layout fits
+		size_t fBytes = 9 * ((nodes + VLEN - 1) / VLEN) * VLEN * sizeof(prec);
+	#endif
+	size_t uBytes = nodes * sizeof(unsigned char);
 
 	hipMalloc((void**)&(device->w), pBytes); 
 	hipMalloc((void**)&(device->b), pBytes);
@@ -44,9 +51,17 @@ void memoryInit(configStruct config, cudaStruct *deviceOnly,
 	hipMemcpy(device->b, host.b, pBytes, hipMemcpyHostToDevice);
 
 	hipMalloc((void**)&(deviceOnly->h), pBytes);
-	hipMalloc((void**)&(deviceOnly->f1), 9 * pBytes);
-	hipMalloc((void**)&(deviceOnly->f2), 9 * pBytes);
+	hipMalloc((void**)&(deviceOnly->f1), fBytes);
+	hipMalloc((void**)&(deviceOnly->f2), fBytes);
 	hipMalloc((void**)&(deviceOnly->binary1), uBytes);
 	hipMalloc((void**)&(deviceOnly->binary2), uBytes);
+
+	// Per-node scratch of the three step kernels
+	hipMalloc((void**)&(deviceOnly->localf), 9 * pBytes);
+	hipMalloc((void**)&(deviceOnly->forcing), 8 * pBytes);
+	hipMalloc((void**)&(deviceOnly->macro), 3 * pBytes);
+	#if SLOPE
+		hipMalloc((void**)&(deviceOnly->slope), 8 * nodes * sizeof(sprec));
+	#endif
 }
 
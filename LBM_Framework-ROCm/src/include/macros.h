@@ -0,0 +1,78 @@
+#ifndef MACROS_H
+	#define MACROS_H
+
+	#ifndef PREC  
+		#define PREC 64
+	#endif
+
+	#ifndef PDE  
+		#define PDE 1
+	#endif
+
+	#ifndef BC1 
+		#define BC1 1
+	#endif
+
+	#ifndef BC2  
+		#define BC2 0
+	#endif
+
+	// Nodes per block of the AoSoA layout
+	#ifndef VLEN
+		#define VLEN 32
+	#endif
+
+	// Node index type: 64 for grids with 2^31 or more populations, 32 keeps
+	// the cheaper 32-bit index arithmetic of smaller grids
+	#ifndef INDEX
+		#define INDEX 32
+	#endif
+
+	// Bed slope of each SWE link stored at setup (32 or 64 bits per link)
+	// instead of recomputed from b every step; 0 recomputes it
+	#ifndef SLOPE
+		#define SLOPE 0
+	#endif
+
+	// Populations kept as h, momentum and the non-equilibrium second moment
+	// (moments.cuh) instead of 9 values per node; SWE and NSE only
+	#ifndef MOMENTS
+		#define MOMENTS 0
+	#endif
+
+	#if MOMENTS && PDE != 1 && PDE != 4
+		#error "MOMENTS needs the SWE or NSE equilibrium (PDE=1 or PDE=4)"
+	#endif
+
+	// Phase tracing (trace.h); 0 compiles it out
+	#ifndef TRACE
+		#define TRACE 0
+	#endif
+
+	#define LAYOUT_AOS   0
+	#define LAYOUT_SOA   1
+	#define LAYOUT_AOSOA 2
+
+	#define COLL_BGK 0
+	#define COLL_TRT 1
+	#define COLL_MRT 2
+
+	#if PREC==64
+		typedef double prec;
+	#else
+		typedef float prec;
+	#endif
+
+	#if INDEX==64
+		typedef long long idx;
+	#else
+		typedef int idx;
+	#endif
+
+	#if SLOPE==64
+		typedef double sprec;
+	#else
+		typedef float sprec;
+	#endif
+
+#endif
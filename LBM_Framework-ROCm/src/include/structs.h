@@ -13,13 +13,24 @@
 		int timeMax;
 		int dtOut;
 		int blockSize;
+		int autotune;
 		int gridSize;
 		int Lx;
 		int Ly;
+		int layout;
 		prec dx;
 		prec dt;
 		prec e;
 		prec tau;
+		int collision;
+		// TRT: magic parameter (tau - 1/2)(tauMinus - 1/2) and the odd
+		// relaxation time it gives
+		prec magic;
+		prec tauMinus;
+		// MRT: rates of the energy, energy squared and heat flux moments
+		prec sE;
+		prec sEps;
+		prec sQ;
 	} configStruct;
 
 	typedef struct mainStruct {
@@ -34,6 +45,12 @@
 		prec* f2;
 		unsigned char* binary1;
 		unsigned char* binary2;
+		prec* localf;
+		prec* forcing;
+		prec* macro;
+		#if SLOPE
+			sprec* slope;
+		#endif
 	} cudaStruct;
 
 #endif
@@ -0,0 +1,41 @@
+#ifndef TRACE_H
+	#define TRACE_H
+
+	#include <string>
+	#include "macros.h"
+
+	// Phase tracing, built with TRACE=1. Host zones are recorded into per-thread
+	// buffers without locking; kernels are timed with device events that are
+	// only read back when the event pool fills up or the trace is written, so
+	// no launch waits on the device. traceWrite() dumps everything as a
+	// Chrome/Perfetto trace (chrome://tracing, ui.perfetto.dev) and prints the
+	// total time per phase. With TRACE=0 the macros expand to nothing.
+
+	#if TRACE
+		struct traceZone {
+			const char* name;
+			long long begin;
+			traceZone(const char*);
+			~traceZone();
+		};
+
+		void traceKernelBegin(const char*);
+
+		void traceKernelEnd();
+
+		void traceWrite(std::string);
+
+		#define TRACE_CONCAT2(a, b) a##b
+		#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+		#define TRACE_ZONE(name) traceZone TRACE_CONCAT(traceZone, __LINE__)(name)
+		#define TRACE_KERNEL_BEGIN(name) traceKernelBegin(name)
+		#define TRACE_KERNEL_END() traceKernelEnd()
+		#define TRACE_WRITE(file) traceWrite(file)
+	#else
+		#define TRACE_ZONE(name)
+		#define TRACE_KERNEL_BEGIN(name)
+		#define TRACE_KERNEL_END()
+		#define TRACE_WRITE(file)
+	#endif
+
+#endif
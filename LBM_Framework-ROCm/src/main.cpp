@@ -1,19 +1,20 @@
 #include <iomanip>
 #include <stdio.h>
 #include <iostream>
-#include <time.h>
+#include <chrono>
 #include <hip/hip_runtime.h>
 #include "include/structs.h"
 #include "include/macros.h"
+#include "include/trace.h"
 #include "cpp/include/input.h"
 #include "cpp/include/output.h"
 #include "cpp/include/config.h"
 #include "cu/include/LBM.cuh"
 #include "cu/include/utils.cuh"
+#include "cu/include/tune.cuh"
 
 int main(int argc, char* argv[]) {
-	clock_t t1, t2; 
-	t1 = clock();
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
 	mainStruct host;
 	mainStruct device;
 	cudaStruct deviceOnly;
@@ -22,19 +23,21 @@ int main(int argc, char* argv[]) {
 	setConfig(&config, argv, argc);
 	createOutputDir(&config);
 	readInput(&config, &host);
-	writeConfig(config);
 	writeOutput(config, 0, host.w);
 	memoryInit(config, &deviceOnly, &device, host);
+	if (config.autotune != 0)
+		tuneBlockSize(&config, device, &deviceOnly);
+	writeConfig(config);
 
 	std::cout << "Starting LBM loop" << std::endl;
 	LBM(config, host, device, &deviceOnly);
 
 	memoryFree(host, device, deviceOnly);
 
-	t2 = clock();
-	prec elapsedTime = 1000.0 * (prec)(t2 - t1) / CLOCKS_PER_SEC;
+	prec elapsedTime = std::chrono::duration<prec, std::milli>(std::chrono::steady_clock::now() - t1).count();
 	std::cout << "Program successfully terminated\n"
 			  << "Total execution time: " << elapsedTime << "[ms]" << std::endl;
+	TRACE_WRITE(config.outputDir + "trace.json");
 	exit(EXIT_SUCCESS);
 } 
 
@@ -1,11 +0,0 @@
-#ifndef FILES_HH
-	#define FILES_HH
-
-	#include "../../include/structs.h"
-	#include "../../include/macros.h"
-
-	void setConfig(configStruct*, char*[], int);
-
-	void writeConfig(configStruct);
-
-#endif
\ No newline at end of file
@@ -1,8 +0,0 @@
-#ifndef INPUT_HH
-	#define INPUT_HH
-
-	#include "../../include/structs.h"
-
-	void readInput(configStruct*, mainStruct*);
-
-#endif
\ No newline at end of file
@@ -1,11 +0,0 @@
-#ifndef OUTPUT_HH
-	#define OUTPUT_HH
-
-	#include "../../include/structs.h"
-	#include "../../include/macros.h"
-
-	void createOutputDir(configStruct*);
-
-	void writeOutput(configStruct, int, prec*);
-
-#endif
\ No newline at end of file
@@ -1,12 +0,0 @@
-#ifndef FILES_HH
-#define FILES_HH
-
-#include "../../include/structs.h"
-
-void readInput(configStruct*, mainStruct*);
-
-void writeConfig(configStruct);
-
-void writeOutput(configStruct, int, prec*);
-
-#endif
\ No newline at end of file
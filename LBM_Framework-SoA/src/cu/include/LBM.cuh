@@ -1,8 +0,0 @@
-#ifndef LBM_CUH
-	#define LBM_CUH
-
-	#include "../../include/structs.h"
-
-	void LBM(configStruct, mainStruct, mainStruct, cudaStruct*);
-
-#endif
@@ -9,6 +9,7 @@
 #include "include/utils.h"
 #include "../include/structs.h"
 #include "../include/macros.h"
+#include "../include/trace.h"
 
 void createOutputDir(configStruct *config){
 	std::string outputDir = config->outputPath + config->test;
@@ -16,7 +17,7 @@ void createOutputDir(configStruct *config){
 	int c = 1;
 	std::string cStr = "";
 	while (dirExists(outputdirTemp.c_str())) {
-		cStr = static_cast<std::ostringstream*>(&(std::ostringstream() << c))->str();
+		cStr = std::to_string(c);
 		outputdirTemp = outputDir + "_" + cStr;
 		c++;
 	}
@@ -26,6 +27,7 @@ void createOutputDir(configStruct *config){
 }
 
 void writeOutput(configStruct config, int t, prec* w) {
+	TRACE_ZONE("write output");
 	FILE *fp;
 	std::ostringstream numero; 
 	numero << std::setw(5) << std::setfill('0') << std::right << (t);
@@ -34,6 +36,6 @@ void writeOutput(configStruct config, int t, prec* w) {
 		std::cerr << "Can't create output file " << filename << std::endl;
 		exit(EXIT_FAILURE);
 	}
-	fwrite(&w[0], sizeof(prec), config.Lx*config.Ly, fp);
+	fwrite(&w[0], sizeof(prec), (size_t)config.Lx * config.Ly, fp);
 	fclose(fp);
 }
\ No newline at end of file
@@ -44,6 +44,59 @@ int parseArgumentInt(char* arg, std::string name){
 	return value;
 }
 
+// "auto" reuses the tuned block size if cached, "tune" always searches again
+int parseArgumentBlockSize(char* arg, std::string name, int *autotune){
+	std::string value = arg;
+	*autotune = 0;
+	if (value == "auto")
+		*autotune = 1;
+	else if (value == "tune")
+		*autotune = 2;
+	else
+		return parseArgumentInt(arg, name);
+	return 256;
+}
+
+int parseArgumentLayout(char* arg, std::string name){
+	std::string value = arg;
+	if (value == "aos")
+		return LAYOUT_AOS;
+	else if (value == "soa")
+		return LAYOUT_SOA;
+	else if (value == "aosoa")
+		return LAYOUT_AOSOA;
+	std::cerr << "Invalid value " << value << " for argument " << name << std::endl;
+	exit(EXIT_FAILURE);
+}
+
+std::string layoutName(int layout){
+	if (layout == LAYOUT_AOS)
+		return "aos";
+	else if (layout == LAYOUT_AOSOA)
+		return "aosoa";
+	return "soa";
+}
+
+int parseArgumentCollision(char* arg, std::string name){
+	std::string value = arg;
+	if (value == "bgk")
+		return COLL_BGK;
+	else if (value == "trt")
+		return COLL_TRT;
+	else if (value == "mrt")
+		return COLL_MRT;
+	std::cerr << "Invalid value " << value << " for argument " << name << std::endl;
+	exit(EXIT_FAILURE);
+}
+
+std::string collisionName(int collision){
+	if (collision == COLL_TRT)
+		return "trt";
+	else if (collision == COLL_MRT)
+		return "mrt";
+	return "bgk";
+}
+
 void verifyDir(std::string dirType, std::string path){
 	if(!dirExists(path.c_str())){
 		std::cerr << dirType << " directory " << path << " doesn't exist" << std::endl;
@@ -63,7 +116,8 @@ void verifyFile(std::string fileType, std::string filename){
 void showUsage(std::string type, std::string name){
 	std::string message;
 	message = "Usage:\n\t" + name + " [-h] [-i input_path] [-o output_path] [-ts time_steps] "
-			  + "[-dt delta_time] [-do delta_out] [-t tau] [-bs block_size] test\n"  
+			  + "[-dt delta_time] [-do delta_out] [-t tau] [-bs block_size|auto|tune] [-l layout] "
+			  + "[-c collision] [-m magic] [-se rate] [-seps rate] [-sq rate] test\n"  
 			  + "Options: \n"  
 			  + "\t-h,--help\n"
 			  + "\t\tShow this help message\n"
@@ -80,7 +134,17 @@ void showUsage(std::string type, std::string name){
 			  + "\t-t, --tau\n"
 			  + "\t\tValue of relaxation time. The default is 0.8\n"
 			  + "\t-bs, --block-size\n"
-			  + "\t\tNumber of threads per CUDA block. The default is 256";
+			  + "\t\tNumber of threads per CUDA block, or auto to take it from the tuning cache in output_path\n"
+			  + "\t\t(searching once on a miss) and tune to search again. The default is 256\n"
+			  + "\t-l, --layout\n"
+			  + "\t\tPopulation storage layout: aos, soa or aosoa. The default is soa\n"
+			  + "\t-c, --collision\n"
+			  + "\t\tCollision operator: bgk, trt or mrt. The default is bgk\n"
+			  + "\t-m, --magic\n"
+			  + "\t\tTRT magic parameter (tau - 1/2)(tau_minus - 1/2). The default is 0.25\n"
+			  + "\t-se, --rate-e, -seps, --rate-eps, -sq, --rate-q\n"
+			  + "\t\tMRT relaxation rates of the energy, energy squared and heat flux moments.\n"
+			  + "\t\tThe defaults are 1.64, 1.54 and 1.9";
 	if (type == "o")
 		std::cout << message << std::endl;
 	else if (type == "e")
@@ -0,0 +1,195 @@
+#include <iostream>
+#include <iomanip>
+#include <cuda_runtime.h>
+#include "include/setup.cuh"
+#include "include/LBMkernels.cuh"
+#include "include/SWE.cuh"
+#include "include/utils.cuh"
+#include "include/layout.cuh"
+#include "../cpp/include/files.h"
+#include "../include/structs.h"
+#include "../include/macros.h"
+#include "../include/trace.h"
+
+void checkLaunch(const char* kernel) {
+	cudaError_t err = cudaGetLastError();
+	if (err != cudaSuccess)
+		printf("CUDA Error in %s: %s\n", kernel, cudaGetErrorString(err));
+}
+
+#if SLOPE
+	#define SLOPE_ARG deviceOnly->slope
+#else
+	#define SLOPE_ARG (sprec*)NULL
+#endif
+
+// Launches the three kernels of one time step without waiting for them. If
+// marks is given, events are recorded before each kernel and after the last.
+template <class L>
+void timeStep(configStruct config, mainStruct device, cudaStruct *deviceOnly, cudaEvent_t *marks = NULL) {
+	if (marks != NULL)
+		cudaEventRecord(marks[0]);
+	TRACE_KERNEL_BEGIN("First");
+	First<L> <<<config.gridSize,config.blockSize>>> (config, deviceOnly->macro, deviceOnly->forcing, deviceOnly->localf, device.b, SLOPE_ARG, deviceOnly->binary1, 
+								deviceOnly->binary2, deviceOnly->f1, deviceOnly->f2, deviceOnly->h);
+	TRACE_KERNEL_END();
+	checkLaunch("First");
+	if (marks != NULL)
+		cudaEventRecord(marks[1]);
+
+	TRACE_KERNEL_BEGIN("Second");
+	Second <<<config.gridSize,config.blockSize>>> (config, deviceOnly->macro, deviceOnly->forcing, deviceOnly->localf, device.b, deviceOnly->binary1, 
+								deviceOnly->binary2, deviceOnly->f1, deviceOnly->f2, deviceOnly->h);
+	TRACE_KERNEL_END();
+	checkLaunch("Second");
+	if (marks != NULL)
+		cudaEventRecord(marks[2]);
+
+	TRACE_KERNEL_BEGIN("Third");
+	Third<L> <<<config.gridSize,config.blockSize>>> (config, deviceOnly->macro, deviceOnly->forcing, deviceOnly->localf, device.b, deviceOnly->binary1, 
+								deviceOnly->binary2, deviceOnly->f1, deviceOnly->f2, deviceOnly->h);
+	TRACE_KERNEL_END();
+	checkLaunch("Third");
+	if (marks != NULL)
+		cudaEventRecord(marks[3]);
+
+	pointerSwap(deviceOnly);
+}
+
+template <class L>
+void setup(configStruct config, mainStruct device, cudaStruct deviceOnly) {
+	TRACE_ZONE("setup");
+	TRACE_KERNEL_BEGIN("binaryKernel");
+	binaryKernel <<<config.gridSize,config.blockSize>>> (config, deviceOnly.binary1, deviceOnly.binary2);
+	TRACE_KERNEL_END();
+	TRACE_KERNEL_BEGIN("hKernel");
+	hKernel <<<config.gridSize,config.blockSize>>> (config, device.w, device.b, deviceOnly.h);
+	TRACE_KERNEL_END();
+	#if SLOPE
+		TRACE_KERNEL_BEGIN("slopeKernel");
+		slopeKernel <<<config.gridSize,config.blockSize>>> (config, device.b, deviceOnly.slope);
+		TRACE_KERNEL_END();
+	#endif
+	TRACE_KERNEL_BEGIN("fKernel");
+	fKernel<L> <<<config.gridSize,config.blockSize>>> (config, deviceOnly.h, deviceOnly.f1);
+	TRACE_KERNEL_END();
+}
+
+void copyAndWriteResultData(configStruct config, mainStruct host, mainStruct device, cudaStruct deviceOnly, int t){
+	TRACE_ZONE("sample");
+	TRACE_KERNEL_BEGIN("wKernel");
+	wKernel <<<config.gridSize,config.blockSize>>> (config, deviceOnly.h, device.b, device.w);
+	TRACE_KERNEL_END();
+	size_t pBytes = (size_t)config.Lx * config.Ly * sizeof(prec);
+	{
+		TRACE_ZONE("copy w");
+		cudaMemcpy(host.w, device.w, pBytes, cudaMemcpyDeviceToHost);
+	}
+	writeOutput(config, t, host.w);
+}
+
+// Step time is taken with events between outputs, so the loop only waits
+// for the device where an output copy would wait anyway.
+template <class L>
+void LBMloop(configStruct config, mainStruct host, mainStruct device, cudaStruct *deviceOnly) {
+	setup<L>(config, device, *deviceOnly);
+
+	int t = 0;
+	cudaEvent_t ct1, ct2;
+	cudaEventCreate(&ct1);
+	cudaEventCreate(&ct2);
+	prec msecs = 0;
+
+	std::cerr << std::fixed << std::setprecision(1);
+	float dt;
+	TRACE_ZONE("LBM loop");
+	cudaEventRecord(ct1);
+	while (t <= config.timeMax) {
+		t++;
+		timeStep<L>(config, device, deviceOnly);
+		if (config.dtOut != 0 && t%config.dtOut == 0) {
+			cudaEventRecord(ct2);
+			cudaEventSynchronize(ct2);
+			cudaEventElapsedTime(&dt, ct1, ct2);
+			msecs += dt;
+			std::cout << "Time step: " << t << " (" << 100.0*t / config.timeMax << "%)" << std::endl;
+			copyAndWriteResultData(config, host, device, *deviceOnly, t);
+			cudaEventRecord(ct1);
+		}
+	}
+	cudaEventRecord(ct2);
+	cudaEventSynchronize(ct2);
+	cudaEventElapsedTime(&dt, ct1, ct2);
+	msecs += dt;
+	cudaEventDestroy(ct1);
+	cudaEventDestroy(ct2);
+
+	if (config.dtOut == 0) 
+		copyAndWriteResultData(config, host, device, *deviceOnly, t);
+	std::cout << "Average time per time step: " << msecs / config.timeMax << "[ms]" << std::endl;
+}
+
+// Runs warmup steps and then reps batches of steps time steps each, storing
+// the mean time per step of every batch in samples[0..reps-1] (milliseconds).
+// A last batch with events between the kernels stores the mean time of
+// First, Second and Third in kernelMs[0..2]; it is kept out of samples
+// since it waits for the device after every step.
+template <class L>
+void benchLoop(configStruct config, mainStruct device, cudaStruct *deviceOnly,
+			   int warmup, int reps, int steps, double *samples, double *kernelMs) {
+	setup<L>(config, device, *deviceOnly);
+	TRACE_ZONE("bench loop");
+	for (int t = 0; t < warmup; t++)
+		timeStep<L>(config, device, deviceOnly);
+
+	cudaEvent_t ct1, ct2;
+	cudaEventCreate(&ct1);
+	cudaEventCreate(&ct2);
+	float dt;
+	for (int r = 0; r < reps; r++) {
+		cudaEventRecord(ct1);
+		for (int t = 0; t < steps; t++)
+			timeStep<L>(config, device, deviceOnly);
+		cudaEventRecord(ct2);
+		cudaEventSynchronize(ct2);
+		cudaEventElapsedTime(&dt, ct1, ct2);
+		samples[r] = dt / steps;
+	}
+
+	cudaEvent_t marks[4];
+	for (int k = 0; k < 4; k++)
+		cudaEventCreate(&marks[k]);
+	for (int k = 0; k < 3; k++)
+		kernelMs[k] = 0;
+	for (int t = 0; t < steps; t++) {
+		timeStep<L>(config, device, deviceOnly, marks);
+		cudaEventSynchronize(marks[3]);
+		for (int k = 0; k < 3; k++) {
+			cudaEventElapsedTime(&dt, marks[k], marks[k + 1]);
+			kernelMs[k] += dt / steps;
+		}
+	}
+	for (int k = 0; k < 4; k++)
+		cudaEventDestroy(marks[k]);
+	cudaEventDestroy(ct1);
+	cudaEventDestroy(ct2);
+}
+
+void LBMbench(configStruct config, mainStruct device, cudaStruct *deviceOnly,
+			  int warmup, int reps, int steps, double *samples, double *kernelMs) {
+	if (config.layout == LAYOUT_AOS)
+		benchLoop<AoS>(config, device, deviceOnly, warmup, reps, steps, samples, kernelMs);
+	else if (config.layout == LAYOUT_AOSOA)
+		benchLoop<AoSoA>(config, device, deviceOnly, warmup, reps, steps, samples, kernelMs);
+	else
+		benchLoop<SoA>(config, device, deviceOnly, warmup, reps, steps, samples, kernelMs);
+}
+
+void LBM(configStruct config, mainStruct host, mainStruct device, cudaStruct *deviceOnly) {
+	if (config.layout == LAYOUT_AOS)
+		LBMloop<AoS>(config, host, device, deviceOnly);
+	else if (config.layout == LAYOUT_AOSOA)
+		LBMloop<AoSoA>(config, host, device, deviceOnly);
+	else
+		LBMloop<SoA>(config, host, device, deviceOnly);
+}
@@ -5,93 +5,95 @@
 #include "include/SWE.cuh"
 #include "include/PDEfeq.cuh"
 #include "include/BC.cuh"
+#include "include/layout.cuh"
+#include "include/moments.cuh"
+#include "include/lattice.cuh"
+#include "include/collision.cuh"
 #include "../include/structs.h"
 #include "../include/macros.h"
  
-__device__ void calculateMacroscopic(prec* localMacroscopic, prec* localf, prec e, int i){
+__device__ void calculateMacroscopic(prec* localMacroscopic, prec* localf, prec e, idx i){
 	localMacroscopic[3*i] = localf[9*i] + (localf[9*i+1] + localf[9*i+2] + localf[9*i+3] + localf[9*i+4]) + (localf[9*i+5] + localf[9*i+6] + localf[9*i+7] + localf[9*i+8]);
 	localMacroscopic[3*i+1] = e * ((localf[9*i+1] - localf[9*i+3]) + (localf[9*i+5] - localf[9*i+6] - localf[9*i+7] + localf[9*i+8])) / localMacroscopic[3*i];
 	localMacroscopic[3*i+2] = e * ((localf[9*i+2] - localf[9*i+4]) + (localf[9*i+5] + localf[9*i+6] - localf[9*i+7] - localf[9*i+8])) / localMacroscopic[3*i];
 }
 
+template <class L>
 __global__ void First(const configStruct config, prec* localMacroscopic, prec* forcing, prec* localf, 
-	const prec* __restrict__ b, const unsigned char* __restrict__ binary1, 
+	const prec* __restrict__ b, const sprec* __restrict__ slope, const unsigned char* __restrict__ binary1, 
 	const unsigned char* __restrict__ binary2, const prec* __restrict__ f1, 
 	prec* f2, prec* h) {
-	int i = threadIdx.x + blockIdx.x*blockDim.x;	
-	if (i < config.Lx*config.Ly) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;	
+	if (i < (idx)config.Lx*config.Ly) {
 		unsigned char b1 = binary1[i];
 		unsigned char b2 = binary2[i];
 		if(b1 != 0 || b2 != 0){
-			int ex[8] = {1,0,-1,0,1,-1,-1,1};		
-			int ey[8] = {0,1,0,-1,1,1,-1,-1};
 			#if PDE == 1
 				prec factor = 1 / (6 * config.e*config.e);
 				prec localh = h[i];
-				prec localb = b[i];
 				for (int j = 0; j < 4; j++){
-					int index = IDX(i, j, config.Lx, ex, ey);
-					if (index > 0 && index < config.Lx*config.Ly) {
-					forcing[8*i+j] = factor * 9.8 * (localh + h[index]) * (b[index] - localb);
+					idx index = IDX<D2Q9>(i, j+1, config.Lx);
+					if (index > 0 && index < (idx)config.Lx*config.Ly) {
+					forcing[8*i+j] = factor * 9.8 * (localh + h[index]) * bedStep(b, slope, i, j, index);
 					} else {
 						forcing[8*i+j] = 0.0;
 					}
 				}
 				for (int j = 4; j < 8; j++){
-					int index = IDX(i, j, config.Lx, ex, ey);
-					if (index > 0 && index < config.Lx*config.Ly) {
-					forcing[8*i+j] = factor * 0.25 * 9.8 * (localh + h[index]) * (b[index] - localb);
+					idx index = IDX<D2Q9>(i, j+1, config.Lx);
+					if (index > 0 && index < (idx)config.Lx*config.Ly) {
+					forcing[8*i+j] = factor * 0.25 * 9.8 * (localh + h[index]) * bedStep(b, slope, i, j, index);
 					} else {
 						forcing[8*i+j] = 0.0;
 					}
 				}
 			#elif PDE == 5
-				calculateForcingUser(forcing, h, b, config.e, i, config.Lx, ex, ey);
+				calculateForcingUser(forcing, h, b, config.e, i, config.Lx);
 			#else 
 				for (int j = 0; j < 8; j++)
 					forcing[8*i+j] = 0;
 			#endif
 
 
-			localf[9*i] = f1[i]; 
+			localf[9*i] = population<L>(f1, i, 0, config.Lx, config.Ly, config.e); 
 			for (int j = 1; j < 9; j++){
 				if(((b1>>(j-1)) & 1) & (~(b2>>(j-1)) & 1)) 
-					localf[9*i+j] = f1[IDXcm(IDX(i, j-1, config.Lx, ex, ey), j, config.Lx, config.Ly)] + forcing[8*i+j-1];
+					localf[9*i+j] = population<L>(f1, IDX<D2Q9>(i, j, config.Lx), j, config.Lx, config.Ly, config.e) + forcing[8*i+j-1];
 				else if((~(b1>>(j-1)) & 1) & (~(b2>>(j-1)) & 1)) 
-					localf[9*i+j] = f1[IDXcm(i, j, config.Lx, config.Ly)];
+					localf[9*i+j] = population<L>(f1, i, j, config.Lx, config.Ly, config.e);
 			}
 
 			for (int j = 1; j < 9; j++)
 				if((~(b1>>(j-1)) & 1) & ((b2>>(j-1)) & 1)) 
 					#if BC1 == 1
-						OBC(localf, f1, i, j, config.Lx, config.Ly);
+						OBC<L>(localf, f1, i, j, config.Lx, config.Ly, config.e);
 					#elif BC1 == 2
-						PBC(localf, f1, i, j, config.Lx, config.Ly, ex, ey);
+						PBC<L>(localf, f1, i, j, config.Lx, config.Ly, config.e);
 					#elif BC1 == 3
 						BBBC(localf, j);
 					#elif BC1 == 4
 						SBC(localf, j, b1, b2);
 					#elif BC1 == 5
-						UBC1(localf, f1, i, j, config.Lx, config.Ly, ex, ey, b1, b2);
+						UBC1(localf, f1, i, j, config.Lx, config.Ly, b1, b2);
 					#elif BC1 == 6
-						UBC2(localf, f1, i, j, config.Lx, config.Ly, ex, ey, b1, b2);
+						UBC2(localf, f1, i, j, config.Lx, config.Ly, b1, b2);
 					#endif
 
 			#if BC2 != 0
 			for (int j = 1; j < 9; j++)
 				if(((b1>>(j-1)) & 1) & ((b2>>(j-1)) & 1)) 
 					#if BC2 == 1
-						localf[9*i+j] = OBC(localf, f1, i, j, config.Lx, config.Ly);
+						localf[9*i+j] = OBC<L>(localf, f1, i, j, config.Lx, config.Ly, config.e);
 					#elif BC2 == 2
-						localf[9*i+j] = PBC(localf, f1, i, j, config.Lx, config.Ly, ex, ey);
+						localf[9*i+j] = PBC<L>(localf, f1, i, j, config.Lx, config.Ly, config.e);
 					#elif BC2 == 3
 						localf[9*i+j] = BBBC(localf, j);
 					#elif BC2 == 4
 						localf[9*i+j] = SBC(localf, j, b1, b2);
 					#elif BC2 == 5
-						localf[9*i+j] = BC1User(localf, f1, i, j, config.Lx, config.Ly, ex, ey, b1, b2);
+						localf[9*i+j] = BC1User(localf, f1, i, j, config.Lx, config.Ly, b1, b2);
 					#elif BC2 == 6
-						localf[9*i+j] = BC2User(localf, f1, i, j, config.Lx, config.Ly, ex, ey, b1, b2);
+						localf[9*i+j] = BC2User(localf, f1, i, j, config.Lx, config.Ly, b1, b2);
 					#endif
 			#endif
 			
@@ -103,8 +105,8 @@ __global__ void Second(const configStruct config, prec* localMacroscopic, prec*
 	const prec* __restrict__ b, const unsigned char* __restrict__ binary1, 
 	const unsigned char* __restrict__ binary2, const prec* __restrict__ f1, 
 	prec* f2, prec* h) {
-	int i = threadIdx.x + blockIdx.x*blockDim.x;	
-	if (i < config.Lx*config.Ly) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;	
+	if (i < (idx)config.Lx*config.Ly) {
 		unsigned char b1 = binary1[i];
 		unsigned char b2 = binary2[i];
 		if(b1 != 0 || b2 != 0){
@@ -115,12 +117,13 @@ __global__ void Second(const configStruct config, prec* localMacroscopic, prec*
 	}
 }
 
+template <class L>
 __global__ void Third(const configStruct config, prec* localMacroscopic, prec* forcing, prec* localf, 
 	const prec* __restrict__ b, const unsigned char* __restrict__ binary1, 
 	const unsigned char* __restrict__ binary2, const prec* __restrict__ f1, 
 	prec* f2, prec* h) {
-	int i = threadIdx.x + blockIdx.x*blockDim.x;	
-	if (i < config.Lx*config.Ly) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;	
+	if (i < (idx)config.Lx*config.Ly) {
 		unsigned char b1 = binary1[i];
 		unsigned char b2 = binary2[i];
 		if(b1 != 0 || b2 != 0){
@@ -143,8 +146,26 @@ __global__ void Third(const configStruct config, prec* localMacroscopic, prec* f
 				calculateFeqUser(feq, localMacroscopicTmp, config.e);
 			#endif
 			
+			prec fpost[9];
 			for (int j = 0; j < 9; j++)
-				f2[IDXcm(i, j, config.Lx, config.Ly)] = localf[9*i+j] - (localf[9*i+j] - feq[j]) / config.tau;
+				fpost[j] = localf[9*i+j];
+			collide(fpost, feq, config);
+			#if MOMENTS
+				storeMoments(f2, fpost, i, (idx)config.Lx*config.Ly, config.e);
+			#else
+				for (int j = 0; j < 9; j++)
+					f2[L::IDXcm(i, j, config.Lx, config.Ly)] = fpost[j];
+			#endif
 		}
 	}
-}
\ No newline at end of file
+}
+
+#define INSTANTIATE_LAYOUT(L) \
+	template __global__ void First<L>(const configStruct, prec*, prec*, prec*, const prec* __restrict__, \
+		const sprec* __restrict__, const unsigned char* __restrict__, const unsigned char* __restrict__, const prec* __restrict__, prec*, prec*); \
+	template __global__ void Third<L>(const configStruct, prec*, prec*, prec*, const prec* __restrict__, \
+		const unsigned char* __restrict__, const unsigned char* __restrict__, const prec* __restrict__, prec*, prec*);
+
+INSTANTIATE_LAYOUT(AoS)
+INSTANTIATE_LAYOUT(SoA)
+INSTANTIATE_LAYOUT(AoSoA)
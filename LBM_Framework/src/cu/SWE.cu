@@ -1,6 +1,7 @@
 #include <cuda_runtime.h>
 #include "include/SWE.cuh"
 #include "include/utils.cuh"
+#include "include/lattice.cuh"
 #include "../include/structs.h"
 #include "../include/macros.h"
 
@@ -28,16 +29,16 @@ __device__ void calculateFeqSWE(prec* feq, prec* localMacroscopic, prec e){
 }
 
 __device__ void calculateForcingSWE(prec* forcing, prec* h, const prec* __restrict__ b, prec e, 
-									int i, int Lx, int* ex, int* ey){
+									idx i, int Lx){
 	prec factor = 1 / (6 * e*e);
 	prec localh = h[i];
 	prec localb = b[i];
 	for (int j = 0; j < 4; j++){
-		int index = IDX(i, j, Lx, ex, ey);
+		idx index = IDX<D2Q9>(i, j+1, Lx);
 		forcing[8*i+j] = factor * 9.8 * (localh + h[index]) * (b[index] - localb);
 	}
 	for (int j = 4; j < 8; j++){
-		int index = IDX(i, j, Lx, ex, ey);
+		idx index = IDX<D2Q9>(i, j+1, Lx);
 		forcing[8*i+j] = factor * 0.25 * 9.8 * (localh + h[index]) * (b[index] - localb);
 	}
 }
@@ -45,17 +46,29 @@ __device__ void calculateForcingSWE(prec* forcing, prec* h, const prec* __restri
 __global__ void hKernel(const configStruct config, const prec* __restrict__ w,
 	const prec* __restrict__ b, prec* h){
 
-	int i = threadIdx.x + blockIdx.x*blockDim.x;
-	if (i < config.Lx*config.Ly) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)config.Lx*config.Ly) {
 		h[i] = w[i] - b[i];
 	}
 }
 
+// The bed never changes, so the step of every link is stored once
+__global__ void slopeKernel(const configStruct config, const prec* __restrict__ b, sprec* slope){
+
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)config.Lx*config.Ly) {
+		for (int j = 0; j < 8; j++){
+			idx index = IDX<D2Q9>(i, j+1, config.Lx);
+			slope[8*i+j] = (index >= 0 && index < (idx)config.Lx*config.Ly) ? (sprec)(b[index] - b[i]) : 0;
+		}
+	}
+}
+
 __global__ void wKernel(const configStruct config, const prec* __restrict__ h,
 	const prec* __restrict__ b, prec* w){
 
-	int i = threadIdx.x + blockIdx.x*blockDim.x;
-	if (i < config.Lx*config.Ly) {
+	idx i = threadIdx.x + (idx)blockIdx.x*blockDim.x;
+	if (i < (idx)config.Lx*config.Ly) {
 		w[i] = h[i] + b[i];
 	}
 }
@@ -0,0 +1,28 @@
+#ifndef BC_CUH
+	#define BC_CUH
+
+	#include "../../include/macros.h"
+	#include "moments.cuh"
+	#include "lattice.cuh"
+
+	template <class L>
+	__device__ void OBC(prec* localf, const prec* __restrict__ f, idx i, int j, int Lx, int Ly, prec e){
+		localf[9*i+j] = population<L>(f, i, j, Lx, Ly, e);
+	}
+
+	__device__ void BBBC(prec*, int);
+
+	__device__ void SBC(prec*, int, unsigned char, unsigned char);
+
+	template <class L>
+	__device__ void PBC(prec* localf, const prec* __restrict__ f, idx i, int j, 
+						int Lx, int Ly, prec e){
+		int y = i/Lx;
+		int x = i - (idx)y * Lx;
+		int xop = (Lx + x - D2Q9::cx(j))%Lx;
+		int yop = (Ly + y - D2Q9::cy(j))%Ly;
+		idx iop = xop + (idx)yop * Lx;
+		localf[j] = population<L>(f, iop, j, Lx, Ly, e);
+	}
+
+#endif
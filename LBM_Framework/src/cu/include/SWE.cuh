@@ -7,7 +7,7 @@
 	__device__ void calculateFeqSWE(prec*, prec*, prec);
 
 	__device__ void calculateForcingSWE(prec*, prec*, const prec* __restrict__, prec, 
-										int, int, int*, int*); 
+										idx, int); 
 
 	__global__ void hKernel(const configStruct, const prec* __restrict__, 
 						 	const prec* __restrict__, prec*);
@@ -15,4 +15,17 @@
 	__global__ void wKernel(const configStruct, const prec* __restrict__,
 							const prec* __restrict__, prec*);
 
+	__global__ void slopeKernel(const configStruct, const prec* __restrict__, sprec*);
+
+	// Bed step b[index] - b[i] along link j of node i: stored by slopeKernel
+	// in SLOPE builds, read from b otherwise
+	__device__ inline prec bedStep(const prec* __restrict__ b, const sprec* __restrict__ slope,
+								   idx i, int j, idx index){
+		#if SLOPE
+			return slope[8*i+j];
+		#else
+			return b[index] - b[i];
+		#endif
+	}
+
 #endif
@@ -0,0 +1,67 @@
+#ifndef LATTICE_CUH
+	#define LATTICE_CUH
+
+	#include "../../include/macros.h"
+
+	// Compile-time lattice descriptors. Velocities, weights and opposite
+	// directions are constexpr, so with the direction known at compile time
+	// (unrolled loops) neighbour offsets and weights fold into immediates
+	// instead of being loaded from arrays. Direction 0 is the rest
+	// population and the axis directions come first, so D2Q5 is the start
+	// of D2Q9:
+	//   6 2 5
+	//   3 0 1
+	//   7 4 8
+	template <int Q_>
+	struct D2Q;
+
+	template <>
+	struct D2Q<5> {
+		static constexpr int Q = 5;
+		__host__ __device__ static constexpr int cx(int j){
+			constexpr int v[5] = {0,1,0,-1,0};
+			return v[j];
+		}
+		__host__ __device__ static constexpr int cy(int j){
+			constexpr int v[5] = {0,0,1,0,-1};
+			return v[j];
+		}
+		__host__ __device__ static constexpr prec w(int j){
+			return j == 0 ? (prec)1.0 / 3 : (prec)1.0 / 6;
+		}
+		__host__ __device__ static constexpr int opp(int j){
+			constexpr int v[5] = {0,3,4,1,2};
+			return v[j];
+		}
+	};
+
+	template <>
+	struct D2Q<9> {
+		static constexpr int Q = 9;
+		__host__ __device__ static constexpr int cx(int j){
+			constexpr int v[9] = {0,1,0,-1,0,1,-1,-1,1};
+			return v[j];
+		}
+		__host__ __device__ static constexpr int cy(int j){
+			constexpr int v[9] = {0,0,1,0,-1,1,1,-1,-1};
+			return v[j];
+		}
+		__host__ __device__ static constexpr prec w(int j){
+			return j == 0 ? (prec)4.0 / 9 : (j < 5 ? (prec)1.0 / 9 : (prec)1.0 / 36);
+		}
+		__host__ __device__ static constexpr int opp(int j){
+			constexpr int v[9] = {0,3,4,1,2,7,8,5,6};
+			return v[j];
+		}
+	};
+
+	typedef D2Q<5> D2Q5;
+	typedef D2Q<9> D2Q9;
+
+	// Node that population j of node i streams from
+	template <class D>
+	__host__ __device__ inline idx IDX(idx i, int j, int Lx){
+		return i - D::cx(j) - D::cy(j) * (idx)Lx;
+	}
+
+#endif
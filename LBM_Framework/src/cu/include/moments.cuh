@@ -0,0 +1,76 @@
+#ifndef MOMENTS_CUH
+	#define MOMENTS_CUH
+
+	#include "../../include/macros.h"
+	#include "lattice.cuh"
+
+	// Moment storage (MOMENTS=1): f1/f2 hold NMOM values per node instead of
+	// the 9 populations, each value contiguous over all nodes as in SoA:
+	//   0 h (rho for the NSE), 1-2 momentum in lattice units (sum of ex f,
+	//   ey f), 3-5 non-equilibrium second moment xx, yy, xy
+	// A population is rebuilt as its equilibrium plus the regularised
+	// non-equilibrium part w_j Q_j:Pneq / (2 cs^4), Q_j = c_j c_j - cs^2 I,
+	// so the scheme is the regularised LBM. The layout policy only applies to
+	// population storage and is ignored.
+	#define NMOM 6
+
+	// Equilibrium of population j alone, the expressions of calculateFeqSWE
+	// (PDE 1) or calculateFeqNSE (PDE 4)
+	__device__ inline prec feqDirection(int j, prec localh, prec localux, prec localuy, prec e){
+		// the equation's own weights, relative to the axis directions
+		prec wj = (j == 0) ? 4 : ((j < 5) ? 1 : 0.25);
+		prec usq = 1.5 * (localux * localux + localuy * localuy);
+		#if PDE == 1
+			prec factor = 1 / (9 * e*e);
+			prec gh  = 1.5 * 9.8 * localh;
+			if (j == 0)
+				return localh * (1 - factor * (5.0 * gh + 4.0 * usq));
+			prec cu = 3.0 * e * (D2Q9::cx(j) * localux + D2Q9::cy(j) * localuy);
+			return localh * factor * wj * (gh + cu + 4.5 * cu*cu * factor - usq);
+		#else
+			prec factor = 1.0 / 9;
+			prec cu = 3.0 * (D2Q9::cx(j) * localux + D2Q9::cy(j) * localuy);
+			return localh * factor * wj * (1 + cu + 4.5 * cu*cu * factor - usq);
+		#endif
+	}
+
+	// Population j of node i rebuilt from the moments m
+	__device__ inline prec momentPopulation(const prec* __restrict__ m, idx i, int j, idx nodes, prec e){
+		const int cx = D2Q9::cx(j), cy = D2Q9::cy(j);
+		prec localh = m[i];
+		prec feq = feqDirection(j, localh, e * m[i + nodes] / localh, e * m[i + 2*nodes] / localh, e);
+		prec neq = (cx*cx - 1.0/3) * m[i + 3*nodes] + (cy*cy - 1.0/3) * m[i + 4*nodes]
+				 + 2 * cx*cy * m[i + 5*nodes];
+		return feq + 4.5 * D2Q9::w(j) * neq;
+	}
+
+	// Stores the moments of the populations f of node i
+	__device__ inline void storeMoments(prec* m, const prec* f, idx i, idx nodes, prec e){
+		prec localh = f[0] + (f[1] + f[2] + f[3] + f[4]) + (f[5] + f[6] + f[7] + f[8]);
+		prec jx = (f[1] - f[3]) + (f[5] - f[6] - f[7] + f[8]);
+		prec jy = (f[2] - f[4]) + (f[5] + f[6] - f[7] - f[8]);
+		prec localux = e * jx / localh;
+		prec localuy = e * jy / localh;
+		prec neq[9];
+		for (int j = 0; j < 9; j++)
+			neq[j] = f[j] - feqDirection(j, localh, localux, localuy, e);
+		m[i] = localh;
+		m[i + nodes] = jx;
+		m[i + 2*nodes] = jy;
+		m[i + 3*nodes] = (neq[1] + neq[3]) + (neq[5] + neq[6] + neq[7] + neq[8]);
+		m[i + 4*nodes] = (neq[2] + neq[4]) + (neq[5] + neq[6] + neq[7] + neq[8]);
+		m[i + 5*nodes] = neq[5] - neq[6] + neq[7] - neq[8];
+	}
+
+	// Population j of node i as kept in f: read through the layout policy,
+	// or rebuilt from the moments
+	template <class L>
+	__device__ inline prec population(const prec* __restrict__ f, idx i, int j, int Lx, int Ly, prec e){
+		#if MOMENTS
+			return momentPopulation(f, i, j, (idx)Lx * Ly, e);
+		#else
+			return f[L::IDXcm(i, j, Lx, Ly)];
+		#endif
+	}
+
+#endif
@@ -5,6 +5,7 @@
 
 	__global__ void binaryKernel(const configStruct, unsigned char*, unsigned char*); 
 
+	template <class L>
 	__global__ void fKernel(const configStruct, const prec* __restrict__, prec*);
 
 #endif
@@ -0,0 +1,8 @@
+#ifndef TUNE_CUH
+	#define TUNE_CUH
+
+	#include "../../include/structs.h"
+
+	void tuneBlockSize(configStruct*, mainStruct, cudaStruct*);
+
+#endif
@@ -0,0 +1,158 @@
+#include <cuda_runtime.h>
+#include "../include/trace.h"
+
+#if TRACE
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#define TRACE_DEVICE_TID 1000
+#define TRACE_KERNEL_POOL 4096
+
+typedef struct traceEvent {
+	const char* name;
+	long long ts;
+	long long dur;
+} traceEvent;
+
+typedef struct traceBuffer {
+	int tid;
+	std::vector<traceEvent> events;
+} traceBuffer;
+
+static const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+// Only registration takes the lock; each thread then appends to its own buffer
+static std::mutex traceMutex;
+static std::vector<traceBuffer*> traceBuffers;
+
+static long long traceNow() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+static traceBuffer* traceLocal() {
+	static thread_local traceBuffer* buffer = NULL;
+	if (buffer == NULL) {
+		buffer = new traceBuffer;
+		buffer->events.reserve(1 << 16);
+		std::lock_guard<std::mutex> lock(traceMutex);
+		buffer->tid = traceBuffers.size();
+		traceBuffers.push_back(buffer);
+	}
+	return buffer;
+}
+
+static void traceRecord(traceBuffer* buffer, const char* name, long long ts, long long dur) {
+	traceEvent ev = { name, ts, dur };
+	buffer->events.push_back(ev);
+}
+
+traceZone::traceZone(const char* zoneName) : name(zoneName), begin(traceNow()) {}
+
+traceZone::~traceZone() {
+	traceRecord(traceLocal(), name, begin, traceNow() - begin);
+}
+
+// Start/stop event pairs of the kernels launched since the last flush. Times
+// are taken relative to origin, an event whose host time is known.
+static struct traceDevice {
+	bool ready;
+	cudaEvent_t origin;
+	long long originNs;
+	int used;
+	std::vector<cudaEvent_t> start;
+	std::vector<cudaEvent_t> stop;
+	std::vector<const char*> names;
+	traceBuffer buffer;
+} traceDev;
+
+static void traceDeviceInit() {
+	cudaEventCreate(&traceDev.origin);
+	cudaEventRecord(traceDev.origin);
+	cudaEventSynchronize(traceDev.origin);
+	traceDev.originNs = traceNow();
+	traceDev.used = 0;
+	traceDev.buffer.tid = TRACE_DEVICE_TID;
+	traceDev.ready = true;
+}
+
+static void traceFlushKernels() {
+	if (traceDev.used == 0)
+		return;
+	TRACE_ZONE("trace flush");
+	float t0, t1;
+	cudaEventSynchronize(traceDev.stop[traceDev.used - 1]);
+	for (int k = 0; k < traceDev.used; k++) {
+		cudaEventElapsedTime(&t0, traceDev.origin, traceDev.start[k]);
+		cudaEventElapsedTime(&t1, traceDev.origin, traceDev.stop[k]);
+		traceRecord(&traceDev.buffer, traceDev.names[k], traceDev.originNs + (long long)(1e6 * t0),
+					(long long)(1e6 * (t1 - t0)));
+	}
+	traceDev.used = 0;
+}
+
+void traceKernelBegin(const char* name) {
+	if (!traceDev.ready)
+		traceDeviceInit();
+	if (traceDev.used == TRACE_KERNEL_POOL)
+		traceFlushKernels();
+	if (traceDev.used == (int)traceDev.start.size()) {
+		cudaEvent_t start, stop;
+		cudaEventCreate(&start);
+		cudaEventCreate(&stop);
+		traceDev.start.push_back(start);
+		traceDev.stop.push_back(stop);
+		traceDev.names.push_back(name);
+	}
+	traceDev.names[traceDev.used] = name;
+	cudaEventRecord(traceDev.start[traceDev.used]);
+}
+
+void traceKernelEnd() {
+	cudaEventRecord(traceDev.stop[traceDev.used]);
+	traceDev.used++;
+}
+
+static void traceWriteEvents(std::ofstream& out, const traceBuffer* buffer, bool* first,
+							 std::map<std::string, std::pair<double, int> >& totals) {
+	for (size_t k = 0; k < buffer->events.size(); k++) {
+		const traceEvent& ev = buffer->events[k];
+		out << (*first ? "\n" : ",\n") << "{\"name\": \"" << ev.name << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": "
+			<< buffer->tid << ", \"ts\": " << 1e-3 * ev.ts << ", \"dur\": " << 1e-3 * ev.dur << "}";
+		*first = false;
+		totals[ev.name].first += 1e-6 * ev.dur;
+		totals[ev.name].second++;
+	}
+}
+
+void traceWrite(std::string filename) {
+	traceFlushKernels();
+	std::ofstream out(filename.c_str());
+	if (!out.is_open()) {
+		std::cerr << "Can't create trace file " << filename << std::endl;
+		return;
+	}
+	std::map<std::string, std::pair<double, int> > totals;
+	bool first = true;
+	out << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+	out << "\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << TRACE_DEVICE_TID
+		<< ", \"args\": {\"name\": \"device\"}}";
+	first = false;
+	std::lock_guard<std::mutex> lock(traceMutex);
+	for (size_t b = 0; b < traceBuffers.size(); b++)
+		traceWriteEvents(out, traceBuffers[b], &first, totals);
+	traceWriteEvents(out, &traceDev.buffer, &first, totals);
+	out << "\n]}" << std::endl;
+	out.close();
+
+	std::cout << "Trace written to " << filename << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+	for (std::map<std::string, std::pair<double, int> >::iterator it = totals.begin(); it != totals.end(); it++)
+		std::cout << std::setw(14) << it->first << ": " << std::setw(10) << it->second.first << "[ms] in "
+				  << it->second.second << " calls" << std::endl;
+}
+#endif